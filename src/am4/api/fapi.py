@@ -29,7 +29,7 @@ from .models import (
 
 @asynccontextmanager
 async def lifespan(app: FastAPI):
-    utils_init()
+    utils_init(shared_memory=cfg.UTILS_SHARED_MEMORY)
     yield
 
 
@@ -10,6 +10,7 @@ from am4.utils.route import AircraftRoute
 from ..common import (
     HELP_AC_ARG0,
     HELP_ACRO_CFG,
+    HELP_ACRO_CI_MODE,
     HELP_ACRO_MAXDIST,
     HELP_ACRO_MAXFT,
     HELP_ACRO_SORTBY,
@@ -33,6 +34,7 @@ from ..db.models.aircraft import PyAircraft, PyAircraftSuggestion
 from ..db.models.airport import PyAirport, PyAirportSuggestion
 from ..db.models.game import PyUser
 from ..db.models.route import (
+    PyACROptionsCIMode,
     PyACROptionsConfigAlgorithm,
     PyACROptionsMaxDistance,
     PyACROptionsMaxFlightTime,
@@ -147,6 +149,10 @@ class FAPIReqACROptions:
             PyACROptionsSortBy,
             Query(description=HELP_ACRO_SORTBY),
         ] = None,
+        ci_mode: Annotated[
+            PyACROptionsCIMode,
+            Query(description=HELP_ACRO_CI_MODE),
+        ] = None,
     ):
         self.config_algorithm = config_algorithm
         self.max_distance = max_distance
@@ -154,6 +160,7 @@ class FAPIReqACROptions:
         self.tpd_mode = tpd_mode
         self.trips_per_day_per_ac = trips_per_day_per_ac
         self.sort_by = sort_by
+        self.ci_mode = ci_mode
 
     def to_core(self, ac_type: Aircraft.Type) -> AircraftRoute.Options:
         opt = {}
@@ -220,6 +227,19 @@ class FAPIReqACROptions:
                     ],
                 )
             opt["sort_by"] = sb
+        if self.ci_mode is not None:
+            if (cim := AircraftRoute.Options.CIMode.__members__.get(self.ci_mode)) is None:
+                raise HTTPException(
+                    status_code=422,
+                    detail=[
+                        {
+                            "loc": ["query", "ci_mode"],
+                            "msg": "Specified cost index mode does not exist",
+                            "type": "value_error",
+                        }
+                    ],
+                )
+            opt["ci_mode"] = cim
         return AircraftRoute.Options(**opt)
 
 
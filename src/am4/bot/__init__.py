@@ -76,7 +76,7 @@ async def on_command_error(ctx: commands.Context, error: commands.CommandError):
 
 async def start(db_done: asyncio.Event):
     await db_done.wait()
-    utils_init()
+    utils_init(shared_memory=cfg.UTILS_SHARED_MEMORY)
     await bot.add_cog(HelpCog(bot))
     await bot.add_cog(SettingsCog(bot))
     await bot.add_cog(AirportCog(bot))
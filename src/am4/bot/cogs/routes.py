@@ -7,13 +7,14 @@ from concurrent.futures import ThreadPoolExecutor
 import discord
 import orjson
 import pyarrow as pa
+import pyarrow.compute as pc
 from discord.ext import commands
 from pyarrow import csv
 
 from am4.utils.aircraft import Aircraft
 from am4.utils.airport import Airport
 from am4.utils.game import User
-from am4.utils.route import AircraftRoute, Destination, RoutesSearch
+from am4.utils.route import AircraftRoute, Destination, RouteColumns, RoutesSearch
 
 from ...config import cfg
 from ..base import BaseCog
@@ -75,12 +76,59 @@ def add_data(d: Destination, is_cargo: bool, embed: discord.Embed):
     )
 
 
+_ARROW_TYPES = {"B": pa.uint8(), "H": pa.uint16(), "I": pa.uint32(), "f": pa.float32(), "d": pa.float64()}
+
+
+def _to_arrow(col: memoryview | RouteColumns.StringColumn, validity: pa.Buffer | None = None) -> pa.Array:
+    # wraps the column's own memory, no copy is made
+    if isinstance(col, RouteColumns.StringColumn):
+        buffers = [validity, pa.py_buffer(col.offsets), pa.py_buffer(col.data)]
+        return pa.Array.from_buffers(pa.utf8(), len(col), buffers)
+    return pa.Array.from_buffers(_ARROW_TYPES[col.format], len(col), [validity, pa.py_buffer(col)])
+
+
+def routes_table(cols: RouteColumns, is_cargo: bool) -> pa.Table:
+    # the stopover columns are null if the route needs no stopover
+    has_stop = pc.not_equal(_to_arrow(cols.stopover_id), 0).buffers()[1]
+    classes = "lh" if is_cargo else "yjf"
+    return pa.table(
+        {
+            "dest.id": _to_arrow(cols.destination_id),
+            "dest.name": _to_arrow(cols.destination_name),
+            "dest.country": _to_arrow(cols.destination_country),
+            "dest.iata": _to_arrow(cols.destination_iata),
+            "dest.icao": _to_arrow(cols.destination_icao),
+            "stop.id": _to_arrow(cols.stopover_id, has_stop),
+            "stop.name": _to_arrow(cols.stopover_name, has_stop),
+            "stop.country": _to_arrow(cols.stopover_country, has_stop),
+            "stop.iata": _to_arrow(cols.stopover_iata, has_stop),
+            "stop.icao": _to_arrow(cols.stopover_icao, has_stop),
+            "full_dist": _to_arrow(cols.full_distance, has_stop),
+            **{f"dem.{c}": _to_arrow(getattr(cols, f"demand_{c}")) for c in classes},
+            **{f"cfg.{c}": _to_arrow(getattr(cols, f"config_{c}")) for c in classes},
+            **{f"tkt.{c}": _to_arrow(getattr(cols, f"ticket_{c}")) for c in classes},
+            "direct_dist": _to_arrow(cols.direct_distance),
+            "time": _to_arrow(cols.flight_time),
+            "trips_pd_pa": _to_arrow(cols.trips_per_day_per_ac),
+            "num_ac": _to_arrow(cols.num_ac),
+            "income": _to_arrow(cols.income),
+            "fuel": _to_arrow(cols.fuel),
+            "co2": _to_arrow(cols.co2),
+            "chk_cost": _to_arrow(cols.acheck_cost),
+            "repair_cost": _to_arrow(cols.repair_cost),
+            "profit_pt": _to_arrow(cols.profit),
+            "ci": _to_arrow(cols.ci),
+            "contrib_pt": _to_arrow(cols.contribution),
+        }
+    )
+
+
 class ButtonHandler(discord.ui.View):
     def __init__(
         self,
         message: discord.Message,
         destinations: list[Destination],
-        cols: dict[str, list],
+        cols: RouteColumns,
         is_cargo: bool,
         file_suffix: str,
         user: User,
@@ -122,7 +170,7 @@ class ButtonHandler(discord.ui.View):
     async def handle_export_csv(self, interaction: discord.Interaction, button: discord.ui.Button):
         button.disabled = True
         await interaction.response.edit_message(view=self)
-        table = pa.Table.from_pydict({k[3:]: v for k, v in self.cols.items() if not k.startswith("9")})
+        table = routes_table(self.cols, self.is_cargo)
 
         buf = io.BytesIO()
         csv.write_csv(table, buf)
@@ -260,7 +308,7 @@ class RoutesCog(BaseCog):
         if not destinations:
             return
 
-        cols = rs._get_columns(destinations)
+        cols = rs.get_columns(destinations)
         file_suffix = "_".join(
             [
                 ap_query.ap.iata,
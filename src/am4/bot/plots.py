@@ -13,6 +13,8 @@ from matplotlib.figure import Figure
 from matplotlib.ticker import FuncFormatter
 from pyproj import CRS, Transformer
 
+from am4.utils.route import RouteColumns
+
 from .utils import format_num
 
 _executor = ProcessPoolExecutor(max_workers=1)
@@ -66,7 +68,7 @@ class MPLMap:
 
     def _plot_destinations(
         self,
-        cols: dict[str, list],
+        cols: dict[str, np.ndarray],
         origin_lng: float,
         origin_lat: float,
     ) -> io.BytesIO:
@@ -81,15 +83,15 @@ class MPLMap:
         ext = 2**24
         ax.imshow(im.astype(np.uint16), extent=[-ext, ext, -ext, ext])
 
-        lats = cols["98|dest.lat"]
-        lngs = cols["99|dest.lng"]
-        tpdpas = np.array(cols["22|trips_pd_pa"])
-        profits = np.array(cols["29|profit_pt"]) * tpdpas
+        lats = cols["destination_lat"]
+        lngs = cols["destination_lng"]
+        tpdpas = cols["trips_per_day_per_ac"]
+        profits = cols["profit"] * tpdpas
         sc_d = ax.scatter(*self.transformer.transform(lats, lngs), c=profits, s=0.5, cmap=self.cmap)
         ax.plot(*self.transformer.transform([origin_lat], [origin_lng]), "ro", markersize=3)
         legend = ax.legend(*sc_d.legend_elements(fmt=FuncFormatter(format_num)), title="$/d/ac")
 
-        ac_needs = cols["23|num_ac"]
+        ac_needs = cols["num_ac"]
         c = 0
         y1 = []
         for acn, pro in zip(ac_needs, profits):
@@ -101,7 +103,7 @@ class MPLMap:
         bins = np.arange(min(y1), max(y1) + binwidth, binwidth)
         ax3.hist(y1, bins=bins, alpha=0.4, orientation="horizontal")
 
-        dists = cols["20|direct_dist"]
+        dists = cols["direct_distance"]
         sc_tpdpa = ax2.scatter(dists, profits, s=1.5, c=tpdpas, cmap=self.cmap2)
         legend = ax2.legend(*sc_tpdpa.legend_elements(), title="t/d/ac", loc="upper left")
         ax2.add_artist(legend)
@@ -114,12 +116,15 @@ class MPLMap:
 
     async def plot_destinations(
         self,
-        cols: dict[str, list],
+        cols: RouteColumns,
         origin_lng: float,
         origin_lat: float,
     ) -> io.BytesIO:
+        # the plotting process only gets the columns it needs, as arrays pickled in one piece each
+        names = ("destination_lat", "destination_lng", "trips_per_day_per_ac", "profit", "num_ac", "direct_distance")
+        arrays = {name: np.array(getattr(cols, name)) for name in names}
         loop = asyncio.get_event_loop()
-        return await loop.run_in_executor(_executor, self._plot_destinations, cols, origin_lng, origin_lat)
+        return await loop.run_in_executor(_executor, self._plot_destinations, arrays, origin_lng, origin_lat)
 
 
 mpl_map = MPLMap()
@@ -11,9 +11,9 @@ By default, the fastest engine option is used (priority 0).
 For slower engine options, specify the engine option in the query.
 """
 HELP_ACRO_CFG = (
-    "[Optional] **Aircraft configuration algorithm**: one of `AUTO`, `FJY`, `FYJ`, `JFY`, `JYF`, `YFJ`, `YJF`"
-    " (pax/vip aircraft), or `AUTO`, `L`, `H` (cargo aircraft). If not specified, `AUTO` is used, "
-    "which selects the best order for that distance class."
+    "[Optional] **Aircraft configuration algorithm**: one of `AUTO`, `FJY`, `FYJ`, `JFY`, `JYF`, `YFJ`, `YJF`,"
+    " `BEST` (pax/vip aircraft), or `AUTO`, `L`, `H` (cargo aircraft). If not specified, `AUTO` is used, "
+    "which selects the best order for that distance class. `BEST` tries all six orders and keeps the most profitable."
 )
 HELP_ACRO_MAXDIST = "[Optional] **Maximum route distance (km)** - defaults to 6371π if not specified."
 HELP_ACRO_MAXFT = "[Optional] **Maximum flight time (h)** - defaults to 24 if not specified."
@@ -25,7 +25,15 @@ HELP_ACRO_TPD = (
     "[Optional] **Trips per day**: defaults to 1. Note that this parameter is only respected when tpd_mode is set "
     "to `STRICT_ALLOW_MULTIPLE_AC` or `STRICT`. When `tpd_mode=AUTO`, it throws an error."
 )
-HELP_ACRO_SORTBY = "[Optional] **Sort by**: one of `PER_AC_PER_DAY`, `PROFIT_PER_AC_PER_DAY`."
+HELP_ACRO_SORTBY = (
+    "[Optional] **Sort by**: one of `PER_TRIP`, `PER_AC_PER_DAY`, `PER_FLIGHT_HOUR`, `PER_AC_COST`, "
+    "`CONTRIBUTION_PER_AC_PER_DAY`."
+)
+HELP_ACRO_CI_MODE = (
+    "[Optional] **Cost index mode**: one of `MAX`, `PROFIT`, `CONTRIBUTION`. If not specified, `MAX` is used, which "
+    "flies at CI 200. `PROFIT` and `CONTRIBUTION` pick the CI of each route with the highest profit or contribution "
+    "per aircraft per day."
+)
 HELP_U_WEAR_TRAINING = "**Wear training** (default: `0`)"
 HELP_U_REPAIR_TRAINING = "**Repair training** (default: `0`)"
 HELP_U_L_TRAINING = "**L training** (default: `0`)"
@@ -40,6 +40,8 @@ class Config(BaseModel):
     LOG_LEVEL: str = "DEBUG"
     JSON_LOGS: bool = False
     DEBUG: bool = False
+    # e.g. "am4utils": processes on the same host share one copy of the tables ("am4utils-compact" in compact mode)
+    UTILS_SHARED_MEMORY: str | None = None
     _source: Path | None = None
 
     def save_to_internal(self):
@@ -24,7 +24,7 @@ class PyCargoConfig(BaseModel):
     algorithm: PyCargoConfigAlgorithm
 
 
-PyConfigAlgorithmPax = Literal["AUTO", "FJY", "FYJ", "JFY", "JYF", "YFJ", "YJF"]
+PyConfigAlgorithmPax = Literal["AUTO", "FJY", "FYJ", "JFY", "JYF", "YFJ", "YJF", "BEST"]
 PyConfigAlgorithmCargo = Literal["AUTO", "L", "H"]
 
 
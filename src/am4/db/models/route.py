@@ -30,7 +30,14 @@ PyACROptionsMaxDistance = Annotated[float, Field(gt=100, lt=65536)]
 PyACROptionsMaxFlightTime = Annotated[float, Field(gt=0, lt=72)]
 PyACROptionsTPDMode = Literal["AUTO", "STRICT_ALLOW_MULTIPLE_AC", "STRICT"]
 PyACROptionsTripsPerDayPerAC = Annotated[int, Field(ge=1, lt=65536)]
-PyACROptionsSortBy = Literal["PER_TRIP", "PER_AC_PER_DAY"]
+PyACROptionsSortBy = Literal[
+    "PER_TRIP",
+    "PER_AC_PER_DAY",
+    "PER_FLIGHT_HOUR",
+    "PER_AC_COST",
+    "CONTRIBUTION_PER_AC_PER_DAY",
+]  # not NET_OF_HUB_COST: every route of a single-origin search shares the hub cost, so it ranks like PER_AC_PER_DAY
+PyACROptionsCIMode = Literal["MAX", "PROFIT", "CONTRIBUTION"]
 
 
 class PyACRouteStopover(BaseModel):
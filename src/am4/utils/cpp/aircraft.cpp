@@ -5,6 +5,7 @@
 #include <string>
 
 #include "include/db.hpp"
+#include "include/pool.hpp"
 #include "include/util.hpp"
 
 Aircraft::Aircraft() : speed_mod(false), fuel_mod(false), co2_mod(false), fourx_mod(false), valid(false) {}
@@ -154,32 +155,66 @@ std::vector<Aircraft::Suggestion> Aircraft::suggest(const ParseResult& parse_res
     return suggestions;
 }
 
+constexpr size_t SEARCH_MANY_CHUNK_SIZE = 16;  // queries per unit of work in the thread pool
+
+static std::vector<Aircraft::BatchResult> lookup_many(
+    const std::vector<string>& queries, const User& user, bool suggest
+) {
+    std::vector<Aircraft::BatchResult> results(queries.size());
+    ThreadPool::Default()->parallel_for(queries.size(), SEARCH_MANY_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            auto result = Aircraft::search(queries[i], user);
+            if (result.ac->valid) {
+                results[i].ac = std::move(result.ac);
+            } else if (suggest) {
+                results[i].suggestions = Aircraft::suggest(result.parse_result);
+            }
+        }
+    });
+    return results;
+}
+
+std::vector<Aircraft::BatchResult> Aircraft::search_many(const std::vector<string>& queries, const User& user) {
+    return lookup_many(queries, user, false);
+}
+
+std::vector<Aircraft::BatchResult> Aircraft::suggest_many(const std::vector<string>& queries, const User& user) {
+    return lookup_many(queries, user, true);
+}
+
+std::vector<shared_ptr<Aircraft>> Aircraft::autocomplete(const string& prefix, size_t n) {
+    string prefix_lower = prefix;
+    std::transform(prefix_lower.begin(), prefix_lower.end(), prefix_lower.begin(), ::tolower);
+    return Database::Client()->autocomplete_aircraft(prefix_lower, n);
+}
+
+// chunk: flattened, with the column types of the aircrafts query in Database::populate_internal
 Aircraft::Aircraft(const duckdb::unique_ptr<duckdb::DataChunk>& chunk, idx_t row)
-    : id(chunk->GetValue(0, row).GetValue<uint16_t>()),
-      shortname(chunk->GetValue(1, row).GetValue<string>()),
-      manufacturer(chunk->GetValue(2, row).GetValue<string>()),
-      name(chunk->GetValue(3, row).GetValue<string>()),
-      type(static_cast<Aircraft::Type>(chunk->GetValue(4, row).GetValue<uint8_t>())),
-      priority(chunk->GetValue(5, row).GetValue<uint8_t>()),
-      eid(chunk->GetValue(6, row).GetValue<uint16_t>()),
-      ename(chunk->GetValue(7, row).GetValue<string>()),
-      speed(chunk->GetValue(8, row).GetValue<float>()),
-      fuel(chunk->GetValue(9, row).GetValue<float>()),
-      co2(chunk->GetValue(10, row).GetValue<float>()),
-      cost(chunk->GetValue(11, row).GetValue<uint32_t>()),
-      capacity(chunk->GetValue(12, row).GetValue<uint32_t>()),
-      rwy(chunk->GetValue(13, row).GetValue<uint16_t>()),
-      check_cost(chunk->GetValue(14, row).GetValue<uint32_t>()),
-      range(chunk->GetValue(15, row).GetValue<uint16_t>()),
-      ceil(chunk->GetValue(16, row).GetValue<uint16_t>()),
-      maint(chunk->GetValue(17, row).GetValue<uint16_t>()),
-      pilots(chunk->GetValue(18, row).GetValue<uint8_t>()),
-      crew(chunk->GetValue(19, row).GetValue<uint8_t>()),
-      engineers(chunk->GetValue(20, row).GetValue<uint8_t>()),
-      technicians(chunk->GetValue(21, row).GetValue<uint8_t>()),
-      img(chunk->GetValue(22, row).GetValue<string>()),
-      wingspan(chunk->GetValue(23, row).GetValue<uint8_t>()),
-      length(chunk->GetValue(24, row).GetValue<uint8_t>()),
+    : id(flat_value<uint16_t>(chunk, 0, row)),
+      shortname(flat_string(chunk, 1, row)),
+      manufacturer(flat_string(chunk, 2, row)),
+      name(flat_string(chunk, 3, row)),
+      type(static_cast<Aircraft::Type>(flat_value<uint8_t>(chunk, 4, row))),
+      priority(flat_value<uint8_t>(chunk, 5, row)),
+      eid(flat_value<uint16_t>(chunk, 6, row)),
+      ename(flat_string(chunk, 7, row)),
+      speed(flat_value<float>(chunk, 8, row)),
+      fuel(flat_value<float>(chunk, 9, row)),
+      co2(flat_value<float>(chunk, 10, row)),
+      cost(flat_value<uint32_t>(chunk, 11, row)),
+      capacity(flat_value<uint32_t>(chunk, 12, row)),
+      rwy(flat_value<uint16_t>(chunk, 13, row)),
+      check_cost(flat_value<uint32_t>(chunk, 14, row)),
+      range(flat_value<uint16_t>(chunk, 15, row)),
+      ceil(flat_value<uint16_t>(chunk, 16, row)),
+      maint(flat_value<uint16_t>(chunk, 17, row)),
+      pilots(flat_value<uint8_t>(chunk, 18, row)),
+      crew(flat_value<uint8_t>(chunk, 19, row)),
+      engineers(flat_value<uint8_t>(chunk, 20, row)),
+      technicians(flat_value<uint8_t>(chunk, 21, row)),
+      img(flat_string(chunk, 22, row)),
+      wingspan(flat_value<uint8_t>(chunk, 23, row)),
+      length(flat_value<uint8_t>(chunk, 24, row)),
       speed_mod(false),
       fuel_mod(false),
       co2_mod(false),
@@ -300,6 +335,72 @@ Aircraft::PaxConfig Aircraft::PaxConfig::calc_yjf_conf(const PaxDemand& d_pf, ui
     return config;
 };
 
+// The six orders are filled side by side, one lane each (padded to 8, the extra lanes are never valid). Lane o fills
+// one class after the other: the first two take as many seats as are demanded and the last one what is left. Seats are
+// divided by the seat size with a float multiply (exact for 16-bit counts: 1/2 is exact and 1/3f rounds up by less
+// than 1e-8), so the lanes have no division and no branches and the loop over them is vectorised.
+constexpr size_t NUM_PAX_LANES = 8;
+constexpr Aircraft::PaxConfig::Algorithm PAX_LANE_ALGORITHM[6] = {
+    Aircraft::PaxConfig::Algorithm::FJY, Aircraft::PaxConfig::Algorithm::FYJ, Aircraft::PaxConfig::Algorithm::JFY,
+    Aircraft::PaxConfig::Algorithm::JYF, Aircraft::PaxConfig::Algorithm::YJF, Aircraft::PaxConfig::Algorithm::YFJ,
+};
+// [step][lane]: the seat size of the class filled at each step
+constexpr uint32_t PAX_LANE_SIZE[3][NUM_PAX_LANES] = {
+    {3, 3, 2, 2, 1, 1, 1, 1},
+    {2, 1, 3, 1, 2, 3, 1, 1},
+    {1, 2, 1, 3, 3, 2, 1, 1},
+};
+constexpr float PAX_LANE_SIZE_INV[3][NUM_PAX_LANES] = {
+    {1.f / 3, 1.f / 3, .5f, .5f, 1.f, 1.f, 1.f, 1.f},
+    {.5f, 1.f, 1.f / 3, 1.f, .5f, 1.f / 3, 1.f, 1.f},
+    {1.f, .5f, 1.f, 1.f / 3, 1.f / 3, .5f, 1.f, 1.f},
+};
+
+Aircraft::PaxConfig Aircraft::PaxConfig::calc_best_conf(
+    const PaxDemand& d_pf, uint16_t capacity, const PaxTicket& ticket
+) {
+    const uint32_t y = d_pf.y, j = d_pf.j, f = d_pf.f;
+    const uint32_t ty = ticket.y, tj = ticket.j, tf = ticket.f;
+    // [step][lane], in the order of PAX_LANE_SIZE
+    const uint32_t demand[3][NUM_PAX_LANES] = {
+        {f, f, j, j, y, y, 0, 0}, {j, y, f, y, j, f, 0, 0}, {y, j, y, f, f, j, 0, 0}
+    };
+    const uint32_t price[3][NUM_PAX_LANES] = {
+        {tf, tf, tj, tj, ty, ty, 0, 0}, {tj, ty, tf, ty, tj, tf, 0, 0}, {ty, tj, ty, tf, tf, tj, 0, 0}
+    };
+
+    uint32_t seats[3][NUM_PAX_LANES];
+    uint32_t income[NUM_PAX_LANES];
+    bool valid[NUM_PAX_LANES];
+    for (size_t o = 0; o < NUM_PAX_LANES; o++) {
+        uint32_t free_seats = capacity;
+        for (size_t step = 0; step < 3; step++) {
+            const uint32_t fit = static_cast<uint32_t>(static_cast<float>(free_seats) * PAX_LANE_SIZE_INV[step][o]);
+            seats[step][o] = step < 2 ? std::min(demand[step][o], fit) : fit;
+            free_seats -= seats[step][o] * PAX_LANE_SIZE[step][o];
+        }
+        valid[o] = seats[2][o] < demand[2][o];
+        income[o] = seats[0][o] * price[0][o] + seats[1][o] * price[1][o] + seats[2][o] * price[2][o];
+    }
+
+    size_t best = 0;  // FJY, invalid, if no order is valid
+    bool found = false;
+    for (size_t o = 0; o < 6; o++) {
+        const bool better = valid[o] && (!found || income[o] > income[best]);
+        best = better ? o : best;
+        found = found || valid[o];
+    }
+
+    PaxConfig config;
+    // back from steps to classes: the seat size of a class is 1 (y), 2 (j) or 3 (f)
+    uint16_t* by_size[4] = {nullptr, &config.y, &config.j, &config.f};
+    for (size_t step = 0; step < 3; step++)
+        *by_size[PAX_LANE_SIZE[step][best]] = static_cast<uint16_t>(seats[step][best]);
+    config.valid = valid[best];
+    config.algorithm = PAX_LANE_ALGORITHM[best];
+    return config;
+}
+
 Aircraft::PaxConfig Aircraft::PaxConfig::calc_pax_conf(
     const PaxDemand& d_pf,
     uint16_t capacity,
@@ -342,6 +443,8 @@ Aircraft::PaxConfig Aircraft::PaxConfig::calc_pax_conf(
             return calc_yfj_conf(d_pf, capacity);
         case Algorithm::YJF:
             return calc_yjf_conf(d_pf, capacity);
+        case Algorithm::BEST:  // ranked by the optimal pax ticket: AircraftRoute passes its own (pax or vip) ticket
+            return calc_best_conf(d_pf, capacity, PaxTicket::from_optimal(distance, game_mode));
         default:
             return PaxConfig();
     }
@@ -363,6 +466,8 @@ inline const string to_string(Aircraft::PaxConfig::Algorithm algorithm) {
             return "YFJ";
         case Aircraft::PaxConfig::Algorithm::YJF:
             return "YJF";
+        case Aircraft::PaxConfig::Algorithm::BEST:
+            return "BEST";
         default:
             return "UNKNOWN";
     }
@@ -488,7 +593,8 @@ void pybind_init_aircraft(py::module_& m) {
         .value("JFY", Aircraft::PaxConfig::Algorithm::JFY)
         .value("JYF", Aircraft::PaxConfig::Algorithm::JYF)
         .value("YJF", Aircraft::PaxConfig::Algorithm::YJF)
-        .value("YFJ", Aircraft::PaxConfig::Algorithm::YFJ);
+        .value("YFJ", Aircraft::PaxConfig::Algorithm::YFJ)
+        .value("BEST", Aircraft::PaxConfig::Algorithm::BEST);
     pc_class.def_readonly("y", &Aircraft::PaxConfig::y)
         .def_readonly("j", &Aircraft::PaxConfig::j)
         .def_readonly("f", &Aircraft::PaxConfig::f)
@@ -567,10 +673,24 @@ void pybind_init_aircraft(py::module_& m) {
         .def(py::init<shared_ptr<Aircraft>, double>())
         .def_readonly("ac", &Aircraft::Suggestion::ac)
         .def_readonly("score", &Aircraft::Suggestion::score);
+    py::class_<Aircraft::BatchResult>(ac_class, "BatchResult")
+        .def_readonly("ac", &Aircraft::BatchResult::ac)
+        .def_readonly("suggestions", &Aircraft::BatchResult::suggestions);
     ac_class
         .def_static(
             "search", &Aircraft::search, "s"_a, py::arg_v("user", User::Default(), "am4.utils.game.User.Default()")
         )
-        .def_static("suggest", &Aircraft::suggest, "s"_a);
+        .def_static("suggest", &Aircraft::suggest, "s"_a)
+        .def_static(
+            "search_many", &Aircraft::search_many, "queries"_a,
+            py::arg_v("user", User::Default(), "am4.utils.game.User.Default()"),
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def_static(
+            "suggest_many", &Aircraft::suggest_many, "queries"_a,
+            py::arg_v("user", User::Default(), "am4.utils.game.User.Default()"),
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def_static("autocomplete", &Aircraft::autocomplete, "prefix"_a, "n"_a = 5);
 }
 #endif
\ No newline at end of file
@@ -1,66 +1,58 @@
 #include <iostream>
 #include <algorithm>
 #include <string>
+#include <string_view>
 
 #include "include/db.hpp"
 #include "include/airport.hpp"
+#include "include/pool.hpp"
 #include "include/route.hpp"
 #include "include/util.hpp"
 
 Airport::Airport() : valid(false) {}
 
+// case-insensitive match of an uppercase `prefix` at the start of s
+static inline bool has_prefix(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), s.begin(), [](char p, char c) {
+               return p == ::toupper(static_cast<unsigned char>(c));
+           });
+}
+
+static inline string to_upper(std::string_view s) {
+    string upper(s);
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    return upper;
+}
+
 Airport::ParseResult Airport::parse(const string& s) {
-    string s_upper = s;
-    std::transform(s_upper.begin(), s_upper.end(), s_upper.begin(), ::toupper);
-
-    if (s_upper.substr(0, 5) == "IATA:") {
-        return ParseResult(SearchType::IATA, s_upper.substr(5));
-    } else if (s_upper.substr(0, 5) == "ICAO:") {
-        return Airport::ParseResult(SearchType::ICAO, s_upper.substr(5));
-    } else if (s_upper.substr(0, 5) == "NAME:") {
-        return ParseResult(SearchType::NAME, s_upper.substr(5));
-    } else if (s_upper.substr(0, 9) == "FULLNAME:") {
-        return ParseResult(SearchType::FULLNAME, s_upper.substr(9));
-    } else if (s_upper.substr(0, 3) == "ID:") {
+    const std::string_view sv = s;
+    if (has_prefix(sv, "IATA:")) {
+        return ParseResult(SearchType::IATA, to_upper(sv.substr(5)));
+    } else if (has_prefix(sv, "ICAO:")) {
+        return ParseResult(SearchType::ICAO, to_upper(sv.substr(5)));
+    } else if (has_prefix(sv, "NAME:")) {
+        return ParseResult(SearchType::NAME, to_upper(sv.substr(5)));
+    } else if (has_prefix(sv, "FULLNAME:")) {
+        return ParseResult(SearchType::FULLNAME, to_upper(sv.substr(9)));
+    } else if (has_prefix(sv, "ID:")) {
         uint16_t id;
-        if (str_to_uint16(s.substr(3), id)) {
-            return ParseResult(SearchType::ID, s.substr(3));
+        if (str_to_uint16(sv.substr(3), id)) {
+            return ParseResult(SearchType::ID, string(sv.substr(3)));
         }
-    } else if (s_upper.substr(0, 4) == "ALL:") {
-        return ParseResult(SearchType::ALL, s_upper.substr(4));
+    } else if (has_prefix(sv, "ALL:")) {
+        return ParseResult(SearchType::ALL, to_upper(sv.substr(4)));
     }
-    return ParseResult(SearchType::ALL, s_upper);
+    return ParseResult(SearchType::ALL, to_upper(sv));
 }
 
 Airport::SearchResult Airport::search(const string& s) {
+    static const shared_ptr<Airport> not_found = make_shared<Airport>();
     auto parse_result = Airport::parse(s);
-    Airport ap;
-    switch (parse_result.search_type) {
-        case SearchType::ALL:
-            ap = Database::Client()->get_airport_by_all(parse_result.search_str);
-            break;
-        case SearchType::IATA:
-            ap = Database::Client()->get_airport_by_iata(parse_result.search_str);
-            break;
-        case SearchType::ICAO:
-            ap = Database::Client()->get_airport_by_icao(parse_result.search_str);
-            break;
-        case SearchType::NAME:
-            ap = Database::Client()->get_airport_by_name(parse_result.search_str);
-            break;
-        case SearchType::FULLNAME:
-            ap = Database::Client()->get_airport_by_fullname(parse_result.search_str);
-            break;
-        case SearchType::ID:
-            uint16_t id;
-            if (str_to_uint16(parse_result.search_str, id)) {
-                ap = Database::Client()->get_airport_by_id(id);
-            } else {
-                ap = Airport();
-            }
-            break;
-    }
-    return SearchResult(make_shared<Airport>(ap), parse_result);
+    auto client = Database::Client();
+    const uint16_t idx = client->find_airport_idx(parse_result.search_type, parse_result.search_str);
+    if (idx == AIRPORT_COUNT) return SearchResult(not_found, std::move(parse_result));
+    // aliasing constructor: shares ownership of the database instead of copying the airport
+    return SearchResult(shared_ptr<Airport>(client, &client->airports[idx]), std::move(parse_result));
 }
 
 // note: searchtype id will return no suggestions.
@@ -88,20 +80,52 @@ std::vector<Airport::Suggestion> Airport::suggest(const ParseResult& parse_resul
     return suggestions;
 }
 
+constexpr size_t SEARCH_MANY_CHUNK_SIZE = 16;  // queries per unit of work in the thread pool
+
+static std::vector<Airport::BatchResult> lookup_many(const std::vector<string>& queries, bool suggest) {
+    std::vector<Airport::BatchResult> results(queries.size());
+    ThreadPool::Default()->parallel_for(queries.size(), SEARCH_MANY_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            auto result = Airport::search(queries[i]);
+            if (result.ap->valid) {
+                results[i].ap = std::move(result.ap);
+            } else if (suggest) {
+                results[i].suggestions = Airport::suggest(result.parse_result);
+            }
+        }
+    });
+    return results;
+}
+
+std::vector<Airport::BatchResult> Airport::search_many(const std::vector<string>& queries) {
+    return lookup_many(queries, false);
+}
+
+std::vector<Airport::BatchResult> Airport::suggest_many(const std::vector<string>& queries) {
+    return lookup_many(queries, true);
+}
+
+std::vector<shared_ptr<Airport>> Airport::autocomplete(const string& prefix, size_t n) {
+    string prefix_upper = prefix;
+    std::transform(prefix_upper.begin(), prefix_upper.end(), prefix_upper.begin(), ::toupper);
+    return Database::Client()->autocomplete_airport(prefix_upper, n);
+}
+
+// chunk: flattened, with the column types of the airports query in Database::populate_internal
 Airport::Airport(const duckdb::unique_ptr<duckdb::DataChunk>& chunk, idx_t row)
-    : id(chunk->GetValue(0, row).GetValue<uint16_t>()),
-      name(chunk->GetValue(1, row).GetValue<string>()),
-      fullname(chunk->GetValue(2, row).GetValue<string>()),
-      country(chunk->GetValue(3, row).GetValue<string>()),
-      continent(chunk->GetValue(4, row).GetValue<string>()),
-      iata(chunk->GetValue(5, row).GetValue<string>()),
-      icao(chunk->GetValue(6, row).GetValue<string>()),
-      lat(chunk->GetValue(7, row).GetValue<double>()),
-      lng(chunk->GetValue(8, row).GetValue<double>()),
-      rwy(chunk->GetValue(9, row).GetValue<uint16_t>()),
-      market(chunk->GetValue(10, row).GetValue<uint8_t>()),
-      hub_cost(chunk->GetValue(11, row).GetValue<uint32_t>()),
-      rwy_codes(chunk->GetValue(12, row).GetValue<string>()),
+    : id(flat_value<uint16_t>(chunk, 0, row)),
+      name(flat_string(chunk, 1, row)),
+      fullname(flat_string(chunk, 2, row)),
+      country(flat_string(chunk, 3, row)),
+      continent(flat_string(chunk, 4, row)),
+      iata(flat_string(chunk, 5, row)),
+      icao(flat_string(chunk, 6, row)),
+      lat(flat_value<double>(chunk, 7, row)),
+      lng(flat_value<double>(chunk, 8, row)),
+      rwy(flat_value<uint16_t>(chunk, 9, row)),
+      market(flat_value<uint8_t>(chunk, 10, row)),
+      hub_cost(flat_value<uint32_t>(chunk, 11, row)),
+      rwy_codes(flat_string(chunk, 12, row)),
       valid(true) {}
 
 inline const string to_string(Airport::SearchType st) {
@@ -185,6 +209,14 @@ void pybind_init_airport(py::module_& m) {
         .def_readonly("ap", &Airport::Suggestion::ap)
         .def_readonly("score", &Airport::Suggestion::score);
 
-    ap_class.def_static("search", &Airport::search, "s"_a).def_static("suggest", &Airport::suggest, "s"_a);
+    py::class_<Airport::BatchResult>(ap_class, "BatchResult")
+        .def_readonly("ap", &Airport::BatchResult::ap)
+        .def_readonly("suggestions", &Airport::BatchResult::suggestions);
+
+    ap_class.def_static("search", &Airport::search, "s"_a)
+        .def_static("suggest", &Airport::suggest, "s"_a)
+        .def_static("search_many", &Airport::search_many, "queries"_a, py::call_guard<py::gil_scoped_release>())
+        .def_static("suggest_many", &Airport::suggest_many, "queries"_a, py::call_guard<py::gil_scoped_release>())
+        .def_static("autocomplete", &Airport::autocomplete, "prefix"_a, "n"_a = 5);
 }
 #endif
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "include/airport.hpp"
 #include "include/aircraft.hpp"
 #include "include/route.hpp"
+#include "include/fleet.hpp"
 
 #include "include/log.hpp"
 
@@ -18,6 +19,7 @@ void pybind_init_demand(py::module_&);
 void pybind_init_airport(py::module_&);
 void pybind_init_aircraft(py::module_&);
 void pybind_init_route(py::module_&);
+void pybind_init_fleet(py::module_&);
 void pybind_init_log(py::module_&);
 
 PYBIND11_MODULE(utils, m) {
@@ -28,6 +30,7 @@ PYBIND11_MODULE(utils, m) {
     pybind_init_airport(m);
     pybind_init_aircraft(m);
     pybind_init_route(m);
+    pybind_init_fleet(m);
     pybind_init_log(m);
 
 #ifdef VERSION_INFO
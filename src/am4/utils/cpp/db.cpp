@@ -1,10 +1,13 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
-#include <queue>
+#define _USE_MATH_DEFINES
+#include <cmath>
 
 #include "include/db.hpp"
 #include "include/ext/jaro.hpp"
+#include "include/pool.hpp"
+#include "include/route.hpp"
 #include "include/util.hpp"
 
 shared_ptr<Database> Database::default_client = nullptr;
@@ -30,236 +33,315 @@ void Database::populate_database() {
     // std::cout << "removed!" << std::endl;
 }
 
-void Database::populate_internal() {
-    auto result = connection->Query("SELECT * FROM read_parquet('~/data/airports.parquet');");
+void Database::populate_internal(bool compact, std::vector<double>* route_distances_out) {
+    // every column is cast to the physical type that the flat_value readers expect, so that schema drift in the parquet
+    // files fails here instead of silently reinterpreting memory. duckdb scans in parallel but preserves row order.
+    auto result = connection->Query(
+        "SELECT id::USMALLINT, name::VARCHAR, fullname::VARCHAR, country::VARCHAR, continent::VARCHAR, "
+        "iata::VARCHAR, icao::VARCHAR, lat::DOUBLE, lng::DOUBLE, rwy::USMALLINT, market::UTINYINT, "
+        "hub_cost::UINTEGER, rwy_codes::VARCHAR "
+        "FROM read_parquet('~/data/airports.parquet');"
+    );
     CHECK_SUCCESS_REF(result);
     idx_t i = 0;
     while (auto chunk = result->Fetch()) {
+        chunk->Flatten();
+        if (i + chunk->size() > AIRPORT_COUNT) throw DatabaseException("airports.parquet: too many rows");
         for (idx_t j = 0; j < chunk->size(); j++, i++) {
             airports[i] = Airport(chunk, j);
         }
     }
-    const uint16_t apid_breakpoints[] = {52,   178,  248,  318,  538,  542,  544,  552,  558,  562,  570,  572,  577,
-                                         597,  1110, 1130, 1162, 1200, 1249, 1265, 1306, 1309, 1311, 1313, 1326, 1328,
-                                         1356, 1358, 1378, 1381, 1388, 1391, 1468, 1481, 1513, 1528, 1532, 1537, 1540,
-                                         1541, 1543, 1571, 1592, 1598, 1625, 1683, 1696, 2382, 2400, 2533, 2557, 2559,
-                                         2566, 2573, 2577, 2591, 2597, 2610, 2627, 2630, 2646, 2648, 2656, 2660, 2662,
-                                         2664, 2665, 2667, 2673, 3053, 3194, 3506, 3508, 3550, 3899, 3982};
-    uint16_t start_bp = 1, offset = 1;
-    for (uint16_t bp : apid_breakpoints) {
-        for (uint16_t j = start_bp; j <= bp; j++) {
-            airport_id_hashtable[j] = j - offset;
-        }
-        offset++;
-        start_bp = bp + 1;
-    }
 
-    result = connection->Query("SELECT * FROM read_parquet('~/data/aircrafts.parquet');");
+    result = connection->Query(
+        "SELECT id::USMALLINT, shortname::VARCHAR, manufacturer::VARCHAR, name::VARCHAR, type::UTINYINT, "
+        "priority::UTINYINT, eid::USMALLINT, ename::VARCHAR, speed::FLOAT, fuel::FLOAT, co2::FLOAT, cost::UINTEGER, "
+        "capacity::UINTEGER, rwy::USMALLINT, check_cost::UINTEGER, range::USMALLINT, ceil::USMALLINT, "
+        "maint::USMALLINT, pilots::UTINYINT, crew::UTINYINT, engineers::UTINYINT, technicians::UTINYINT, "
+        "img::VARCHAR, wingspan::UTINYINT, length::UTINYINT "
+        "FROM read_parquet('~/data/aircrafts.parquet');"
+    );
     CHECK_SUCCESS_REF(result);
     i = 0;
     while (auto chunk = result->Fetch()) {
-        for (uint16_t j = 0; j < chunk->size(); j++, i++) {
+        chunk->Flatten();
+        if (i + chunk->size() > AIRCRAFT_COUNT) throw DatabaseException("aircrafts.parquet: too many rows");
+        for (idx_t j = 0; j < chunk->size(); j++, i++) {
             aircrafts[i] = Aircraft(chunk, j);
         }
     }
 
-    result = connection->Query("SELECT yd, jd, fd, d FROM read_parquet('~/data/routes.parquet');");
+    // read distances into a temporary in route order first, which both representations and the snapshot derive from
+    pax_demands_data.resize(ROUTE_COUNT);
+    std::vector<double> route_distances(ROUTE_COUNT);
+    result = connection->Query(
+        "SELECT yd::USMALLINT, jd::USMALLINT, fd::USMALLINT, d::DOUBLE FROM read_parquet('~/data/routes.parquet');"
+    );
     CHECK_SUCCESS_REF(result);
     i = 0;
-    uint16_t x = 0, y = 0;
     while (auto chunk = result->Fetch()) {
-        for (idx_t j = 0; j < chunk->size(); j++, i++) {
-            pax_demands[i] = PaxDemand(
-                chunk->GetValue(0, j).GetValue<uint16_t>(), chunk->GetValue(1, j).GetValue<uint16_t>(),
-                chunk->GetValue(2, j).GetValue<uint16_t>()
-            );
-            y++;
-            if (y == AIRPORT_COUNT) {
-                x++;
-                y = x + 1;
+        chunk->Flatten();
+        const idx_t n = chunk->size();
+        if (i + n > ROUTE_COUNT) throw DatabaseException("routes.parquet: too many rows");
+        const uint16_t* yd = duckdb::FlatVector::GetData<uint16_t>(chunk->data[0]);
+        const uint16_t* jd = duckdb::FlatVector::GetData<uint16_t>(chunk->data[1]);
+        const uint16_t* fd = duckdb::FlatVector::GetData<uint16_t>(chunk->data[2]);
+        const double* d = duckdb::FlatVector::GetData<double>(chunk->data[3]);
+        PaxDemand* pd_out = pax_demands_data.data() + i;
+        for (idx_t j = 0; j < n; j++) pd_out[j] = PaxDemand(yd[j], jd[j], fd[j]);
+        std::copy(d, d + n, route_distances.begin() + i);
+        i += n;
+    }
+    if (i != ROUTE_COUNT) throw DatabaseException("routes.parquet: expected " + to_string(ROUTE_COUNT) + " rows");
+
+    // release the unused representation, if any, to actually give the memory back
+    if (compact) {
+        std::vector<double>().swap(distances_data);
+        compact_distances_data.resize(ROUTE_COUNT);
+        for (i = 0; i < ROUTE_COUNT; i++) compact_distances_data[i] = static_cast<float>(route_distances[i]);
+    } else {
+        std::vector<float>().swap(compact_distances_data);
+        distances_data.assign(static_cast<size_t>(AIRPORT_COUNT) * AIRPORT_COUNT, 0.0);
+        i = 0;
+        for (uint16_t x = 0; x < AIRPORT_COUNT; x++) {
+            for (uint16_t y = x + 1; y < AIRPORT_COUNT; y++, i++) {
+                distances_data[x * AIRPORT_COUNT + y] = route_distances[i];
+                distances_data[y * AIRPORT_COUNT + x] = route_distances[i];
             }
-            const double distance = chunk->GetValue(3, j).GetValue<double>();
-            distances[x][y] = distance;
-            distances[y][x] = distance;
         }
     }
+    use_owned_tables();
+    build_indices();
+    if (route_distances_out) *route_distances_out = std::move(route_distances);
+}
+
+void Database::use_owned_tables() {
+    pax_demands = pax_demands_data.empty() ? nullptr : pax_demands_data.data();
+    distances = distances_data.empty() ? nullptr : distances_data.data();
+    compact_distances = compact_distances_data.empty() ? nullptr : compact_distances_data.data();
+    snapshot.reset();
+}
+
+void Database::build_indices() {
+    airport_iata_idx.clear();
+    airport_icao_idx.clear();
+    airport_name_idx.clear();
+    airport_fullname_idx.clear();
+    for (auto* index : {&airport_iata_idx, &airport_icao_idx, &airport_name_idx, &airport_fullname_idx})
+        index->reserve(AIRPORT_COUNT);
+    for (uint16_t i = 0; i < AIRPORT_COUNT; i++) {
+        const Airport& ap = airports[i];
+        string name = ap.name;
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        string fullname = ap.name + ", " + ap.country;
+        std::transform(fullname.begin(), fullname.end(), fullname.begin(), ::toupper);
+        // emplace keeps the existing (lower) index for duplicates
+        airport_iata_idx.emplace(ap.iata, i);
+        airport_icao_idx.emplace(ap.icao, i);
+        airport_name_idx.emplace(std::move(name), i);
+        airport_fullname_idx.emplace(std::move(fullname), i);
+    }
+
+    std::vector<std::vector<string>> ap_fields(4, std::vector<string>(AIRPORT_COUNT));
+    for (uint16_t i = 0; i < AIRPORT_COUNT; i++) {
+        const Airport& ap = airports[i];
+        ap_fields[0][i] = ap.iata;
+        ap_fields[1][i] = ap.icao;
+        ap_fields[2][i] = ap.name;
+        std::transform(ap.name.begin(), ap.name.end(), ap_fields[2][i].begin(), ::toupper);
+        ap_fields[3][i] = ap_fields[2][i] + ", " + ap.country;
+        std::transform(ap_fields[3][i].begin(), ap_fields[3][i].end(), ap_fields[3][i].begin(), ::toupper);
+    }
+    airport_suggestions.build(ap_fields, std::vector<bool>(AIRPORT_COUNT, true));
+
+    std::vector<std::vector<string>> ac_fields(2, std::vector<string>(AIRCRAFT_COUNT));
+    std::vector<bool> ac_enabled(AIRCRAFT_COUNT);
+    for (uint16_t i = 0; i < AIRCRAFT_COUNT; i++) {
+        const Aircraft& ac = aircrafts[i];
+        ac_fields[0][i] = ac.shortname;
+        ac_fields[1][i] = ac.name;
+        std::transform(ac.name.begin(), ac.name.end(), ac_fields[1][i].begin(), ::tolower);
+        ac_enabled[i] = ac.priority == 0;
+    }
+    aircraft_suggestions.build(ac_fields, ac_enabled);
+
+    // "HONG KONG INTL" -> "HONG KONG INTL", "KONG INTL", "INTL"
+    auto word_keys = [](const string& s, std::vector<string>& keys) {
+        for (size_t i = 0; i < s.size(); i++) {
+            if (i == 0 || s[i - 1] == ' ') keys.push_back(s.substr(i));
+        }
+    };
+    std::vector<std::vector<string>> ap_keys(AIRPORT_COUNT);
+    std::vector<uint64_t> ap_ranks(AIRPORT_COUNT);
+    for (uint16_t i = 0; i < AIRPORT_COUNT; i++) {
+        ap_keys[i] = {ap_fields[0][i], ap_fields[1][i]};
+        word_keys(ap_fields[2][i], ap_keys[i]);
+        ap_ranks[i] = (static_cast<uint64_t>(airports[i].market) << 32) | airports[i].hub_cost;
+    }
+    airport_prefixes.build(ap_keys, ap_ranks, std::vector<bool>(AIRPORT_COUNT, true));
+
+    std::vector<std::vector<string>> ac_keys(AIRCRAFT_COUNT);
+    std::vector<uint64_t> ac_ranks(AIRCRAFT_COUNT);
+    for (uint16_t i = 0; i < AIRCRAFT_COUNT; i++) {
+        ac_keys[i] = {ac_fields[0][i]};
+        word_keys(ac_fields[1][i], ac_keys[i]);
+        ac_ranks[i] = aircrafts[i].capacity;
+    }
+    aircraft_prefixes.build(ac_keys, ac_ranks, ac_enabled);
+
+    airport_grid.build(airports);
+}
+
+// the stored distances are not guaranteed to be exactly spherical, so windows are padded generously.
+AirportGrid::Window AirportGrid::Window::around(double lat, double lng, double radius) {
+    constexpr double EARTH_RADIUS = 6371.0;
+    constexpr double DEG = 180.0 / M_PI;
+    const double r = radius * 1.01 / EARTH_RADIUS + 1.0 / DEG;  // angular radius in rad
+
+    Window w;
+    w.lat_lo = lat - r * DEG;
+    w.lat_hi = lat + r * DEG;
+    w.lng_center = lng;
+    if (w.lat_lo <= -90.0 || w.lat_hi >= 90.0 || r >= M_PI_2) {
+        w.lng_half = 180.0;  // contains a pole
+    } else {
+        w.lng_half = asin(std::min(1.0, sin(r) / cos(lat / DEG))) * DEG;
+    }
+    return w;
+}
+
+void AirportGrid::build(const Airport (&airports)[AIRPORT_COUNT]) {
+    std::fill(std::begin(cell_start), std::end(cell_start), 0);
+    std::fill(std::begin(cell_max_rwy), std::end(cell_max_rwy), 0);
+    for (const Airport& ap : airports) {
+        const int cell = cell_of(ap.lat, ap.lng);
+        cell_start[cell + 1]++;
+        cell_max_rwy[cell] = std::max(cell_max_rwy[cell], ap.rwy);
+    }
+    for (int cell = 0; cell < CELL_COUNT; cell++) cell_start[cell + 1] += cell_start[cell];
+
+    uint16_t fill[CELL_COUNT];
+    std::copy(std::begin(cell_start), std::end(cell_start) - 1, std::begin(fill));
+    for (uint16_t idx = 0; idx < AIRPORT_COUNT; idx++) {
+        cell_airports[fill[cell_of(airports[idx].lat, airports[idx].lng)]++] = idx;
+    }
 }
 
-const uint16_t missing_apids[] = {52,   178,  248,  318,  538,  542,  544,  552,  558,  562,  571,  572,  577,
-                                  597,  1110, 1130, 1162, 1200, 1249, 1265, 1306, 1310, 1311, 1313, 1326, 1328,
-                                  1356, 1358, 1378, 1381, 1388, 1391, 1468, 1481, 1513, 1528, 1532, 1537, 1540,
-                                  1542, 1543, 1571, 1592, 1598, 1625, 1683, 1696, 2382, 2400, 2533, 2557, 2559,
-                                  2566, 2573, 2577, 2591, 2597, 2610, 2627, 2630, 2647, 2648, 2656, 2660, 2662,
-                                  2664, 2666, 2667, 2673, 3053, 3194, 3507, 3508, 3550, 3899};
 Airport Database::get_airport_by_id(uint16_t id) {
-    if (std::find(std::begin(missing_apids), std::end(missing_apids), id) != std::end(missing_apids)) return Airport();
-    if (id > 3982) return Airport();
+    if (id > AIRPORT_ID_MAX || MISSING_APID_SET.test(id)) return Airport();
     return airports[airport_id_hashtable[id]];
 }
 
-// TODO: use unordered_map or gperf instead of linear search
+static inline uint16_t find_key(const std::unordered_map<string, uint16_t>& index, const string& key) {
+    auto it = index.find(key);
+    return it == index.end() ? AIRPORT_COUNT : it->second;
+}
+
+uint16_t Database::find_airport_idx(Airport::SearchType type, const string& key) const {
+    uint16_t id;
+    switch (type) {
+        case Airport::SearchType::IATA:
+            return find_key(airport_iata_idx, key);
+        case Airport::SearchType::ICAO:
+            return find_key(airport_icao_idx, key);
+        case Airport::SearchType::NAME:
+            return find_key(airport_name_idx, key);
+        case Airport::SearchType::FULLNAME:
+            return find_key(airport_fullname_idx, key);
+        case Airport::SearchType::ID:
+            if (!str_to_uint16(key, id) || id > AIRPORT_ID_MAX || MISSING_APID_SET.test(id)) return AIRPORT_COUNT;
+            return airport_id_hashtable[id];
+        case Airport::SearchType::ALL:
+            break;
+    }
+    if (str_to_uint16(key, id) && id <= AIRPORT_ID_MAX && !MISSING_APID_SET.test(id)) return airport_id_hashtable[id];
+    // the first airport matching any of the keys wins
+    uint16_t best = AIRPORT_COUNT;
+    for (const auto* index : {&airport_iata_idx, &airport_icao_idx, &airport_name_idx, &airport_fullname_idx})
+        best = std::min(best, find_key(*index, key));
+    return best;
+}
+
+static inline Airport airport_at(const Airport* airports, uint16_t idx) {
+    return idx == AIRPORT_COUNT ? Airport() : airports[idx];
+}
+
 Airport Database::get_airport_by_iata(const string& iata) {
-    auto it = std::find_if(std::begin(airports), std::end(airports), [&](const Airport& a) { return a.iata == iata; });
-    return it == std::end(airports) ? Airport() : *it;
+    return airport_at(airports, find_airport_idx(Airport::SearchType::IATA, iata));
 }
 
 Airport Database::get_airport_by_icao(const string& icao) {
-    auto it = std::find_if(std::begin(airports), std::end(airports), [&](const Airport& a) { return a.icao == icao; });
-    return it == std::end(airports) ? Airport() : *it;
+    return airport_at(airports, find_airport_idx(Airport::SearchType::ICAO, icao));
 }
 
 Airport Database::get_airport_by_name(const string& name) {
-    auto it = std::find_if(std::begin(airports), std::end(airports), [&](const Airport& a) {
-        string db_name = a.name;
-        std::transform(db_name.begin(), db_name.end(), db_name.begin(), ::toupper);
-        return db_name == name;
-    });
-    return it == std::end(airports) ? Airport() : *it;
+    return airport_at(airports, find_airport_idx(Airport::SearchType::NAME, name));
 }
 
 Airport Database::get_airport_by_fullname(const string& name) {
-    auto it = std::find_if(std::begin(airports), std::end(airports), [&](const Airport& a) {
-        string db_fullname = a.name + ", " + a.country;
-        std::transform(db_fullname.begin(), db_fullname.end(), db_fullname.begin(), ::toupper);
-        return db_fullname == name;
-    });
-    return it == std::end(airports) ? Airport() : *it;
+    return airport_at(airports, find_airport_idx(Airport::SearchType::FULLNAME, name));
 }
 
 Airport Database::get_airport_by_all(const string& all) {
-    uint16_t id;
-    if (str_to_uint16(all, id)) {
-        Airport ap = get_airport_by_id(id);
-        if (ap.valid) return ap;
-    }
-    auto it = std::find_if(std::begin(airports), std::end(airports), [&](const Airport& a) {
-        string db_name = a.name;
-        std::transform(db_name.begin(), db_name.end(), db_name.begin(), ::toupper);
-        string db_fullname = db_name + ", " + a.country;
-        std::transform(db_fullname.begin(), db_fullname.end(), db_fullname.begin(), ::toupper);
-        return a.iata == all || a.icao == all || db_name == all || db_fullname == all;
-    });
-    return it == std::end(airports) ? Airport() : *it;
+    return airport_at(airports, find_airport_idx(Airport::SearchType::ALL, all));
 }
 
-template <typename ScoreFn>
-std::vector<Airport::Suggestion> Database::suggest_airport(const string& input, ScoreFn score_fn) {
-    std::priority_queue<Airport::Suggestion, std::vector<Airport::Suggestion>, CompareSuggestion> pq;
-    for (const Airport& ap : airports) {
-        double score = score_fn(input, ap);
-        if (pq.size() < 5) {
-            pq.emplace(std::make_shared<Airport>(ap), score);
-        } else if (score > pq.top().score) {
-            pq.pop();
-            pq.emplace(std::make_shared<Airport>(ap), score);
-        }
-    }
+enum : uint32_t {
+    AIRPORT_SUGGEST_IATA = 1 << 0,
+    AIRPORT_SUGGEST_ICAO = 1 << 1,
+    AIRPORT_SUGGEST_NAME = 1 << 2,
+    AIRPORT_SUGGEST_FULLNAME = 1 << 3,
+    AIRPORT_SUGGEST_ALL = 0b1111,
+    AIRCRAFT_SUGGEST_SHORTNAME = 1 << 0,
+    AIRCRAFT_SUGGEST_NAME = 1 << 1,
+    AIRCRAFT_SUGGEST_ALL = 0b11,
+};
+
+std::vector<Airport::Suggestion> Database::suggest_airport(const string& input, uint32_t field_mask) {
     std::vector<Airport::Suggestion> suggestions;
-    while (!pq.empty()) {
-        suggestions.insert(suggestions.begin(), pq.top());
-        pq.pop();
-    }
+    for (const auto& hit : airport_suggestions.top(input, field_mask))
+        suggestions.emplace_back(std::make_shared<Airport>(airports[hit.record]), hit.score);
     return suggestions;
 }
 
 std::vector<Airport::Suggestion> Database::suggest_airport_by_iata(const string& iata) {
-    return suggest_airport(iata, [](const string& input, const Airport& ap) {
-        return jaro_winkler_distance(input, ap.iata);
-    });
+    return suggest_airport(iata, AIRPORT_SUGGEST_IATA);
 }
 
 std::vector<Airport::Suggestion> Database::suggest_airport_by_icao(const string& icao) {
-    return suggest_airport(icao, [](const string& input, const Airport& ap) {
-        return jaro_winkler_distance(input, ap.icao);
-    });
+    return suggest_airport(icao, AIRPORT_SUGGEST_ICAO);
 }
 
 std::vector<Airport::Suggestion> Database::suggest_airport_by_name(const string& name) {
-    return suggest_airport(name, [](const string& input, const Airport& ap) {
-        string ap_name = ap.name;
-        std::transform(ap_name.begin(), ap_name.end(), ap_name.begin(), ::toupper);
-        return jaro_winkler_distance(input, ap_name);
-    });
+    return suggest_airport(name, AIRPORT_SUGGEST_NAME);
 }
 
 std::vector<Airport::Suggestion> Database::suggest_airport_by_fullname(const string& name) {
-    return suggest_airport(name, [](const string& input, const Airport& ap) {
-        string ap_fullname = ap.name + ", " + ap.country;
-        std::transform(ap_fullname.begin(), ap_fullname.end(), ap_fullname.begin(), ::toupper);
-        return jaro_winkler_distance(input, ap_fullname);
-    });
+    return suggest_airport(name, AIRPORT_SUGGEST_FULLNAME);
 }
 
 std::vector<Airport::Suggestion> Database::suggest_airport_by_all(const string& name) {
-    return suggest_airport(name, [](const string& input, const Airport& ap) {
-        string ap_name = ap.name;
-        std::transform(ap_name.begin(), ap_name.end(), ap_name.begin(), ::toupper);
-        string ap_fullname = ap_name + ", " + ap.country;
-        std::transform(ap_fullname.begin(), ap_fullname.end(), ap_fullname.begin(), ::toupper);
-        return std::max(
-            std::max(jaro_winkler_distance(input, ap.iata), jaro_winkler_distance(input, ap.icao)),
-            std::max(jaro_winkler_distance(input, ap_name), jaro_winkler_distance(input, ap_fullname))
-        );
-    });
+    return suggest_airport(name, AIRPORT_SUGGEST_ALL);
+}
+
+std::vector<shared_ptr<Airport>> Database::autocomplete_airport(const string& prefix, size_t n) {
+    std::vector<shared_ptr<Airport>> completions;
+    for (uint16_t idx : airport_prefixes.complete(prefix, n))
+        completions.push_back(std::make_shared<Airport>(airports[idx]));
+    return completions;
 }
 
+static constexpr auto AIRCRAFT_ID_TABLE = make_aircraft_id_table(AIRCRAFT_COUNT);
+
+// an out of range priority falls back to the first engine variant. unknown ids return 0.
 uint16_t Database::get_aircraft_idx_by_id(uint16_t id, uint8_t priority) {
-    const std::map<uint16_t, uint16_t> idx_id_map{
-        {1, 0},     {2, 4},     {3, 7},     {4, 8},     {5, 10},    {6, 12},    {7, 14},    {8, 17},    {9, 21},
-        {10, 22},   {11, 23},   {12, 24},   {13, 25},   {14, 29},   {15, 30},   {16, 32},   {17, 34},   {18, 36},
-        {19, 37},   {20, 38},   {21, 39},   {22, 41},   {23, 42},   {24, 43},   {25, 46},   {26, 47},   {27, 48},
-        {28, 49},   {29, 50},   {30, 51},   {31, 52},   {32, 53},   {33, 57},   {34, 59},   {35, 60},   {36, 61},
-        {37, 64},   {38, 66},   {39, 69},   {40, 72},   {41, 73},   {42, 74},   {43, 75},   {44, 76},   {45, 77},
-        {46, 78},   {47, 79},   {48, 81},   {49, 82},   {50, 84},   {51, 85},   {52, 89},   {53, 93},   {55, 99},
-        {56, 105},  {58, 106},  {59, 107},  {60, 108},  {61, 109},  {62, 112},  {63, 115},  {64, 118},  {66, 120},
-        {67, 122},  {68, 124},  {69, 127},  {71, 129},  {72, 133},  {73, 137},  {74, 140},  {75, 143},  {76, 146},
-        {85, 147},  {86, 148},  {87, 149},  {89, 151},  {90, 152},  {91, 153},  {92, 154},  {93, 155},  {94, 157},
-        {95, 158},  {96, 159},  {97, 160},  {99, 161},  {100, 162}, {101, 163}, {102, 164}, {103, 166}, {104, 167},
-        {105, 168}, {106, 169}, {107, 170}, {108, 171}, {109, 172}, {110, 173}, {111, 174}, {112, 175}, {113, 178},
-        {114, 180}, {115, 182}, {116, 183}, {117, 184}, {118, 185}, {119, 186}, {120, 187}, {124, 190}, {126, 191},
-        {127, 192}, {128, 193}, {129, 194}, {130, 195}, {131, 196}, {132, 197}, {133, 198}, {134, 199}, {135, 200},
-        {136, 201}, {137, 202}, {138, 203}, {139, 204}, {140, 205}, {141, 206}, {142, 207}, {143, 208}, {144, 209},
-        {145, 210}, {146, 211}, {147, 212}, {148, 213}, {149, 214}, {150, 216}, {151, 217}, {152, 218}, {153, 219},
-        {154, 220}, {155, 221}, {156, 222}, {157, 223}, {158, 224}, {159, 225}, {160, 226}, {161, 227}, {162, 228},
-        {163, 229}, {164, 230}, {165, 231}, {166, 232}, {167, 234}, {168, 235}, {169, 236}, {170, 238}, {171, 241},
-        {172, 242}, {173, 243}, {177, 246}, {178, 247}, {179, 248}, {180, 249}, {181, 250}, {182, 251}, {183, 252},
-        {184, 253}, {185, 254}, {186, 255}, {187, 256}, {189, 257}, {190, 258}, {191, 259}, {192, 260}, {193, 261},
-        {194, 262}, {195, 264}, {196, 265}, {197, 266}, {198, 267}, {199, 268}, {200, 269}, {201, 270}, {202, 272},
-        {203, 273}, {204, 274}, {205, 276}, {206, 277}, {207, 278}, {208, 279}, {209, 280}, {210, 281}, {211, 282},
-        {212, 283}, {213, 284}, {214, 285}, {215, 286}, {216, 287}, {218, 288}, {219, 289}, {220, 290}, {221, 291},
-        {222, 292}, {226, 293}, {227, 296}, {228, 299}, {229, 300}, {230, 303}, {231, 304}, {232, 305}, {233, 307},
-        {234, 309}, {241, 310}, {242, 313}, {243, 319}, {244, 320}, {245, 322}, {246, 323}, {247, 324}, {248, 325},
-        {249, 326}, {250, 328}, {251, 329}, {252, 330}, {253, 331}, {254, 332}, {255, 333}, {256, 334}, {257, 335},
-        {258, 336}, {259, 337}, {260, 338}, {266, 339}, {267, 340}, {268, 341}, {269, 343}, {270, 344}, {271, 345},
-        {272, 348}, {273, 349}, {274, 350}, {275, 351}, {276, 352}, {277, 354}, {281, 355}, {282, 356}, {283, 357},
-        {284, 358}, {285, 359}, {287, 360}, {288, 362}, {289, 363}, {290, 364}, {291, 365}, {292, 366}, {293, 367},
-        {294, 368}, {295, 369}, {298, 370}, {299, 371}, {300, 372}, {302, 374}, {303, 377}, {304, 379}, {305, 380},
-        {306, 381}, {307, 383}, {308, 384}, {309, 385}, {310, 386}, {311, 390}, {312, 394}, {313, 395}, {314, 396},
-        {315, 397}, {316, 399}, {317, 400}, {318, 401}, {320, 405}, {321, 407}, {322, 409}, {323, 413}, {324, 417},
-        {325, 418}, {326, 419}, {327, 420}, {328, 421}, {329, 422}, {330, 423}, {331, 424}, {332, 425}, {333, 426},
-        {334, 427}, {335, 428}, {336, 432}, {337, 434}, {338, 435}, {339, 436}, {340, 438}, {341, 439}, {342, 440},
-        {343, 441}, {344, 442}, {345, 443}, {346, 444}, {347, 445}, {348, 446}, {349, 447}, {350, 448}, {351, 449},
-        {352, 450}, {353, 451}, {355, 453}, {356, 454}, {357, 455}, {358, 457}, {359, 459}, {360, 460}, {361, 464},
-        {362, 468}, {363, 471}, {364, 474}, {365, 475}, {366, 477}, {367, 479}, {368, 480}, {369, 482}, {370, 483},
-        {371, 484}, {372, 485}, {373, 486}, {374, 487}, {375, 488}, {376, 489}, {377, 491}
-    };
-    auto search = idx_id_map.find(id);
-    if (search != idx_id_map.end()) {
-        auto next = std::next(search);
-        if (next != idx_id_map.end()) {
-            if (priority > next->second - search->second - 1) priority = 0;
-        }
-        return search->second + priority;
-    }
-    return 0;
+    if (id > AIRCRAFT_ID_MAX) return 0;
+    const AircraftIdRange& r = AIRCRAFT_ID_TABLE[id];
+    if (r.variants == 0) return 0;
+    return static_cast<uint16_t>(r.first_idx + (priority < r.variants ? priority : 0));
 }
 
-const uint16_t missing_acids[] = {54,  57,  65,  70,  77,  78,  79,  80,  81,  82,  83,  84,  88,  98,  121, 122,
-                                  123, 125, 174, 175, 176, 188, 217, 223, 224, 225, 235, 236, 237, 238, 239, 240,
-                                  261, 262, 263, 264, 265, 278, 279, 280, 286, 296, 297, 301, 319, 354};
 Aircraft Database::get_aircraft_by_id(uint16_t id, uint8_t priority) {
-    if (std::find(std::begin(missing_acids), std::end(missing_acids), id) != std::end(missing_acids)) return Aircraft();
-    if (id > 375) return Aircraft();
+    if (id > AIRCRAFT_ID_SEARCH_MAX || MISSING_ACID_SET.test(id)) return Aircraft();
     return aircrafts[Database::get_aircraft_idx_by_id(id, priority)];
 }
 
@@ -293,53 +375,66 @@ Aircraft Database::get_aircraft_by_all(const string& shortname, uint8_t priority
     return it == std::end(aircrafts) ? Aircraft() : *it;
 }
 
-template <typename ScoreFn>
-std::vector<Aircraft::Suggestion> Database::suggest_aircraft(const string& input, ScoreFn score_fn) {
-    std::priority_queue<Aircraft::Suggestion, std::vector<Aircraft::Suggestion>, CompareSuggestion> pq;
-    for (const Aircraft& ac : aircrafts) {
-        if (ac.priority != 0) continue;
-        double score = score_fn(input, ac);
-        if (pq.size() < 5) {
-            pq.emplace(std::make_shared<Aircraft>(ac), score);
-        } else if (score > pq.top().score) {
-            pq.pop();
-            pq.emplace(std::make_shared<Aircraft>(ac), score);
-        }
-    }
+std::vector<Aircraft::Suggestion> Database::suggest_aircraft(const string& input, uint32_t field_mask) {
     std::vector<Aircraft::Suggestion> suggestions;
-    while (!pq.empty()) {
-        suggestions.insert(suggestions.begin(), pq.top());
-        pq.pop();
-    }
+    for (const auto& hit : aircraft_suggestions.top(input, field_mask))
+        suggestions.emplace_back(std::make_shared<Aircraft>(aircrafts[hit.record]), hit.score);
     return suggestions;
 }
 
 std::vector<Aircraft::Suggestion> Database::suggest_aircraft_by_shortname(const string& name) {
-    return suggest_aircraft(name, [](const string& input, const Aircraft& ac) {
-        return jaro_winkler_distance(input, ac.shortname);
-    });
+    return suggest_aircraft(name, AIRCRAFT_SUGGEST_SHORTNAME);
 }
 
 std::vector<Aircraft::Suggestion> Database::suggest_aircraft_by_name(const string& name) {
-    return suggest_aircraft(name, [](const string& input, const Aircraft& ac) {
-        string ac_name = ac.name;
-        std::transform(ac_name.begin(), ac_name.end(), ac_name.begin(), ::tolower);
-        return jaro_winkler_distance(input, ac_name);
-    });
+    return suggest_aircraft(name, AIRCRAFT_SUGGEST_NAME);
 }
 
 std::vector<Aircraft::Suggestion> Database::suggest_aircraft_by_all(const string& all) {
-    return suggest_aircraft(all, [](const string& input, const Aircraft& ac) {
-        string ac_name = ac.name;
-        std::transform(ac_name.begin(), ac_name.end(), ac_name.begin(), ::tolower);
-        return std::max(jaro_winkler_distance(input, ac.shortname), jaro_winkler_distance(input, ac_name));
-    });
+    return suggest_aircraft(all, AIRCRAFT_SUGGEST_ALL);
+}
+
+std::vector<shared_ptr<Aircraft>> Database::autocomplete_aircraft(const string& prefix, size_t n) {
+    std::vector<shared_ptr<Aircraft>> completions;
+    for (uint16_t idx : aircraft_prefixes.complete(prefix, n))
+        completions.push_back(std::make_shared<Aircraft>(aircrafts[idx]));
+    return completions;
 }
 
-void init(string home_dir) {
+void init(string home_dir, bool compact_distances, bool use_snapshot, string shared_memory) {
     auto client = Database::Client(home_dir);
-    client->populate_internal();
+    const string data_dir = home_dir + "/data";
+    const string snapshot_path = data_dir + "/" + SNAPSHOT_FILENAME;
+    if (!shared_memory.empty() && shared_memory[0] != '/') shared_memory = "/" + shared_memory;
+    // a segment only holds the distance table of its mode: both modes can share a name without evicting each other
+    if (!shared_memory.empty() && compact_distances) shared_memory += "-compact";
+
+    using SharedSnapshot = Database::SharedSnapshot;
+    if (shared_memory.empty() ||
+        client->await_shared_snapshot(shared_memory, data_dir, compact_distances) != SharedSnapshot::ATTACHED) {
+        if (!use_snapshot || !client->load_snapshot(snapshot_path, compact_distances)) {
+            std::vector<double> route_distances;
+            client->populate_internal(compact_distances, &route_distances);
+            // a failure to write a snapshot is never fatal (e.g. a read-only install): we just keep what we loaded
+            if (use_snapshot) {
+                try {
+                    client->write_snapshot(snapshot_path, route_distances.data());
+                } catch (const DatabaseException& e) {
+                    std::cerr << "WARN: " << e.what() << std::endl;
+                }
+            }
+        }
+        if (!shared_memory.empty()) {
+            try {
+                client->share_snapshot(shared_memory, data_dir, compact_distances);
+            } catch (const DatabaseException& e) {
+                std::cerr << "WARN: " << e.what() << std::endl;
+            }
+        }
+    }
     client->populate_database();
+    StopoverCache::Default().clear();
+    HubSearch::clear_cache();
 }
 
 void _debug_query(string query) {
@@ -362,7 +457,8 @@ void pybind_init_db(py::module_& m) {
 
     m_db.def(
             "init",
-            [](std::optional<string> home_dir) {
+            [](std::optional<string> home_dir, bool compact_distances, bool use_snapshot,
+               std::optional<string> shared_memory) {
                 py::gil_scoped_acquire acquire;
                 if (!home_dir.has_value()) {
                     string hdir = py::module::import("am4")
@@ -383,15 +479,21 @@ void pybind_init_db(py::module_& m) {
                             );
                         }
                     }
-                    init(hdir);
+                    init(hdir, compact_distances, use_snapshot, shared_memory.value_or(""));
                 } else {
-                    init(home_dir.value());
+                    init(home_dir.value(), compact_distances, use_snapshot, shared_memory.value_or(""));
                 }
                 py::gil_scoped_release release;
             },
-            "home_dir"_a = py::none()
+            "home_dir"_a = py::none(), "compact_distances"_a = false,
+            "use_snapshot"_a = true, "shared_memory"_a = py::none()
     )
-        .def("_debug_query", &_debug_query, "query"_a);
+        .def("_debug_query", &_debug_query, "query"_a)
+        .def(
+            "set_num_threads", [](size_t num_threads) { ThreadPool::set_default_size(num_threads); },
+            "num_threads"_a
+        )
+        .def("get_num_threads", []() { return ThreadPool::Default()->size(); });
 
     py::module_ m_utils = m_db.def_submodule("utils");
     m_utils.def("jaro_distance", &jaro_distance, "a"_a, "b"_a)
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#include "include/fleet.hpp"
+#include "include/db.hpp"
+#include "include/pool.hpp"
+
+using std::get;
+
+// demand per day in PaxDemand units. for cargo, y stands for 500 lbs of large and j for 1000 lbs of heavy cargo, see
+// CargoDemand(const PaxDemand&).
+struct FleetDemand {
+    double y = 0;
+    double j = 0;
+    double f = 0;
+};
+
+// the demand an aircraft takes from its route every day: its seats (or cargo) times the trips it flies, at the load
+// factor of the user, since route evaluation divides the demand by it.
+static FleetDemand daily_demand_taken(const AircraftRoute::Compact& ar, const Aircraft& ac, const User& user) {
+    const double trips = static_cast<double>(ar.trips_per_day_per_ac) * user.load;
+    if (ar._ac_type == Aircraft::Type::CARGO) {
+        const auto& cfg = get<Aircraft::CargoConfig>(ar.config);
+        const double capacity = static_cast<double>(ac.capacity) / 100.0;
+        const double l = (1 + user.l_training / 100.0) * cfg.l * 0.7 * capacity;
+        const double h = (1 + user.h_training / 100.0) * cfg.h * capacity;
+        return {l / 500.0 * trips, h / 1000.0 * trips, 0};
+    }
+    const auto& cfg = get<Aircraft::PaxConfig>(ar.config);
+    return {cfg.y * trips, cfg.j * trips, cfg.f * trips};
+}
+
+// The assignments made so far and the demand they leave on every route.
+class FleetLedger {
+   public:
+    struct Slot {
+        uint16_t d_idx;
+        uint16_t ac_idx;
+        AircraftRoute::Compact ar;
+        double daily_profit;
+        FleetDemand taken;
+        bool active;
+    };
+
+    const FleetPlanner& planner;
+    const uint16_t o_idx;
+    vector<Slot> slots;       // every assignment ever made, in order
+    vector<uint32_t> version;  // [d_idx]: bumped whenever the aircraft on the route change
+    size_t num_active = 0;
+    double daily_profit = 0;
+    double cost = 0;
+
+    FleetLedger(const FleetPlanner& planner, uint16_t o_idx)
+        : planner(planner), o_idx(o_idx), version(AIRPORT_COUNT, 0), on_route(AIRPORT_COUNT) {}
+
+    // one more aircraft of model ac_idx on the route, against the demand left. invalid if not worth flying.
+    Slot evaluate(uint16_t d_idx, uint16_t ac_idx) const {
+        const Aircraft& ac = planner.aircraft[ac_idx];
+        Slot slot{d_idx, ac_idx, {}, 0, {}, false};
+        slot.ar = AircraftRoute::Compact::create(o_idx, d_idx, ac, planner.options, planner.user, remaining(d_idx));
+        if (!slot.ar.valid) return slot;
+        slot.daily_profit = slot.ar.profit * slot.ar.trips_per_day_per_ac;
+        slot.taken = daily_demand_taken(slot.ar, ac, planner.user);
+        return slot;
+    }
+
+    // the demand left on the route, recomputed from the database in assignment order so that undoing an exchange
+    // restores it exactly
+    PaxDemand remaining(uint16_t d_idx) const {
+        const auto& db = Database::Client();
+        const PaxDemand& pd = db->pax_demands[db->get_dbroute_idx(o_idx, d_idx)];
+        double y = pd.y, j = pd.j, f = pd.f;
+        for (size_t id : on_route[d_idx]) {
+            y -= slots[id].taken.y;
+            j -= slots[id].taken.j;
+            f -= slots[id].taken.f;
+        }
+        auto clamp = [](double x) { return static_cast<uint16_t>(std::clamp(std::floor(x), 0.0, 65535.0)); };
+        return PaxDemand(clamp(y), clamp(j), clamp(f));
+    }
+
+    size_t assign(const Slot& slot) {
+        slots.push_back(slot);
+        slots.back().active = true;
+        on_route[slot.d_idx].push_back(slots.size() - 1);
+        activate(slots.back(), 1);
+        return slots.size() - 1;
+    }
+
+    // returns the position of the aircraft on its route, for restore()
+    size_t remove(size_t id) {
+        auto& ids = on_route[slots[id].d_idx];
+        const size_t pos = static_cast<size_t>(std::find(ids.begin(), ids.end(), id) - ids.begin());
+        ids.erase(ids.begin() + static_cast<std::ptrdiff_t>(pos));
+        slots[id].active = false;
+        activate(slots[id], -1);
+        return pos;
+    }
+
+    void restore(size_t id, size_t pos) {
+        auto& ids = on_route[slots[id].d_idx];
+        ids.insert(ids.begin() + static_cast<std::ptrdiff_t>(pos), id);
+        slots[id].active = true;
+        activate(slots[id], 1);
+    }
+
+    // whether one more aircraft of model ac_idx fits the aircraft count and the budget
+    bool fits(uint16_t ac_idx, size_t max_aircraft, double budget) const {
+        if (max_aircraft != 0 && num_active >= max_aircraft) return false;
+        return budget <= 0 || cost + planner.aircraft[ac_idx].cost <= budget;
+    }
+
+   private:
+    vector<vector<size_t>> on_route;  // [d_idx]: the active slots, in assignment order
+
+    void activate(const Slot& slot, int sign) {
+        version[slot.d_idx]++;
+        num_active = sign > 0 ? num_active + 1 : num_active - 1;
+        daily_profit += sign * slot.daily_profit;
+        cost += sign * static_cast<double>(planner.aircraft[slot.ac_idx].cost);
+    }
+};
+
+FleetPlanner::Plan FleetPlanner::get(size_t max_aircraft, double budget, size_t max_exchanges) const {
+    const auto& db = Database::Client();
+    const auto pool = ThreadPool::Default();
+    const uint16_t o_idx = db->airport_id_hashtable[this->origin.id];
+    const uint16_t num_models = static_cast<uint16_t>(this->aircraft.size());
+    FleetLedger ledger(*this, o_idx);
+    using Slot = FleetLedger::Slot;
+
+    // best first, ties going to the lower destination index, then the earlier model
+    auto better = [](const Slot& a, const Slot& b) {
+        if (a.daily_profit != b.daily_profit) return a.daily_profit > b.daily_profit;
+        return a.d_idx < b.d_idx || (a.d_idx == b.d_idx && a.ac_idx < b.ac_idx);
+    };
+    auto worth = [](const Slot& s) { return s.ar.valid && s.daily_profit > 0; };
+
+    // every (route, model) slot against the full demand, in parallel. table[d_idx * num_models + ac_idx], evaluated at
+    // table_version[d_idx] of the route (versions only ever increase)
+    vector<Slot> table(static_cast<size_t>(AIRPORT_COUNT) * num_models);
+    vector<uint32_t> table_version(AIRPORT_COUNT, 0);
+    pool->parallel_for(AIRPORT_COUNT, ROUTES_SEARCH_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint16_t d_idx = static_cast<uint16_t>(i);
+            if (d_idx == o_idx) continue;
+            for (uint16_t k = 0; k < num_models; k++) table[i * num_models + k] = ledger.evaluate(d_idx, k);
+        }
+    });
+
+    // 1. greedy. the queue holds (slot, route version): the slot of a route that changed since is re-evaluated when it
+    // reaches the top. budget and count only shrink here, so a slot that does not fit any more is dropped.
+    struct Entry {
+        Slot slot;
+        uint32_t version;
+    };
+    auto cmp = [&](const Entry& a, const Entry& b) { return better(b.slot, a.slot); };
+    std::priority_queue<Entry, vector<Entry>, decltype(cmp)> queue(cmp);
+    for (const Slot& slot : table) {
+        if (worth(slot)) queue.push({slot, 0});
+    }
+    while (!queue.empty() && (max_aircraft == 0 || ledger.num_active < max_aircraft)) {
+        const Entry top = queue.top();
+        queue.pop();
+        const uint16_t d_idx = top.slot.d_idx, k = top.slot.ac_idx;
+        if (top.version != ledger.version[d_idx]) {
+            const Slot slot = ledger.evaluate(d_idx, k);
+            if (worth(slot)) queue.push({slot, ledger.version[d_idx]});
+            continue;
+        }
+        if (!ledger.fits(k, max_aircraft, budget)) continue;
+        ledger.assign(top.slot);
+        const Slot next = ledger.evaluate(d_idx, k);  // one more of the same on the same route
+        if (worth(next)) queue.push({next, ledger.version[d_idx]});
+    }
+
+    // 2. local search: remove an aircraft and refill greedily from the table, refreshing the routes that changed
+    auto best_fitting = [&](Slot& best) {
+        bool found = false;
+        for (uint16_t d_idx = 0; d_idx < AIRPORT_COUNT; d_idx++) {
+            if (d_idx == o_idx) continue;
+            Slot* row = &table[static_cast<size_t>(d_idx) * num_models];
+            if (table_version[d_idx] != ledger.version[d_idx]) {
+                for (uint16_t k = 0; k < num_models; k++) row[k] = ledger.evaluate(d_idx, k);
+                table_version[d_idx] = ledger.version[d_idx];
+            }
+            for (uint16_t k = 0; k < num_models; k++) {
+                if (!worth(row[k]) || !ledger.fits(k, max_aircraft, budget)) continue;
+                if (!found || better(row[k], best)) {
+                    best = row[k];
+                    found = true;
+                }
+            }
+        }
+        return found;
+    };
+    vector<size_t> order;
+    for (size_t id = 0; id < ledger.slots.size(); id++) order.push_back(id);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return ledger.slots[a].daily_profit < ledger.slots[b].daily_profit;
+    });
+    for (size_t n = 0; n < std::min(max_exchanges, order.size()); n++) {
+        const size_t id = order[n];
+        const double removed_profit = ledger.slots[id].daily_profit;
+        const size_t pos = ledger.remove(id);
+        vector<size_t> added;
+        double added_profit = 0;
+        Slot slot{};
+        while (best_fitting(slot)) {
+            added.push_back(ledger.assign(slot));
+            added_profit += slot.daily_profit;
+        }
+        if (added_profit > removed_profit + 1e-6) continue;  // kept
+        for (auto it = added.rbegin(); it != added.rend(); ++it) {
+            ledger.remove(*it);
+            ledger.slots.pop_back();  // the last ones, so ids stay valid
+        }
+        ledger.restore(id, pos);
+    }
+
+    Plan plan;
+    for (const Slot& slot : ledger.slots) {
+        if (!slot.active) continue;
+        plan.assignments.push_back({slot.ac_idx, db->airports[slot.d_idx], AircraftRoute(slot.ar), slot.daily_profit});
+        plan.daily_profit += slot.daily_profit;
+        plan.cost += static_cast<double>(this->aircraft[slot.ac_idx].cost);
+    }
+    return plan;
+}
+
+#if BUILD_PYBIND == 1
+#include "include/binder.hpp"
+
+void pybind_init_fleet(py::module_& m) {
+    py::module_ m_fleet = m.def_submodule("fleet");
+
+    py::class_<FleetPlanner> planner_class(m_fleet, "FleetPlanner");
+    py::class_<FleetPlanner::Assignment>(planner_class, "Assignment")
+        .def_readonly("aircraft_idx", &FleetPlanner::Assignment::aircraft_idx)
+        .def_readonly("destination", &FleetPlanner::Assignment::destination)
+        .def_readonly("ac_route", &FleetPlanner::Assignment::ac_route)
+        .def_readonly("daily_profit", &FleetPlanner::Assignment::daily_profit);
+    py::class_<FleetPlanner::Plan>(planner_class, "Plan")
+        .def_readonly("assignments", &FleetPlanner::Plan::assignments)
+        .def_readonly("daily_profit", &FleetPlanner::Plan::daily_profit)
+        .def_readonly("cost", &FleetPlanner::Plan::cost);
+    planner_class
+        .def(
+            py::init<const Airport&, const vector<Aircraft>&, const AircraftRoute::Options&, const User&>(), "ap0"_a,
+            "aircraft"_a, py::arg_v("options", AircraftRoute::Options(), "am4.utils.route.AircraftRoute.Options()"),
+            py::arg_v("user", User::Default(), "am4.utils.game.User.Default()")
+        )
+        .def(
+            "get", &FleetPlanner::get, "max_aircraft"_a, "budget"_a = 0.0, "max_exchanges"_a = 1000,
+            py::call_guard<py::gil_scoped_release>()
+        );
+}
+#endif
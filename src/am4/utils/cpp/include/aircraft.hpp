@@ -24,7 +24,8 @@ struct Aircraft {
             JFY,
             JYF,
             YJF,
-            YFJ
+            YFJ,
+            BEST  // whichever of the six orders earns the most, see calc_best_conf
         };
 
         uint16_t y = 0;
@@ -39,6 +40,9 @@ struct Aircraft {
         static inline PaxConfig calc_jyf_conf(const PaxDemand& d_pf, uint16_t capacity);
         static inline PaxConfig calc_yfj_conf(const PaxDemand& d_pf, uint16_t capacity);
         static inline PaxConfig calc_yjf_conf(const PaxDemand& d_pf, uint16_t capacity);
+        // fills all six orders and returns the valid one with the highest income for `ticket` (ties going to the
+        // earlier order), with `algorithm` set to that order.
+        static PaxConfig calc_best_conf(const PaxDemand& d_pf, uint16_t capacity, const PaxTicket& ticket);
 
         static PaxConfig calc_pax_conf(
             const PaxDemand& pax_demand,
@@ -159,10 +163,22 @@ struct Aircraft {
         Suggestion(shared_ptr<Aircraft> ac, double score) : ac(ac), score(score) {}
     };
 
+    // one per query of search_many / suggest_many
+    struct BatchResult {
+        shared_ptr<Aircraft> ac;              // nullptr if not found
+        std::vector<Suggestion> suggestions;  // suggest_many only, and only if not found
+    };
+
     Aircraft();
     static ParseResult parse(const string& s);
     static SearchResult search(const string& s, const User& user = User::Default());
     static std::vector<Aircraft::Suggestion> suggest(const ParseResult& parse_result);
+    // resolves the queries in parallel on the default thread pool, results are in the order of `queries`
+    static std::vector<BatchResult> search_many(const std::vector<string>& queries, const User& user = User::Default());
+    static std::vector<BatchResult> suggest_many(const std::vector<string>& queries, const User& user = User::Default());
+    // aircraft with a shortname or a word of the name starting with `prefix` (case insensitive), largest first.
+    // only the first engine variant of each aircraft is returned.
+    static std::vector<shared_ptr<Aircraft>> autocomplete(const string& prefix, size_t n = 5);
 
     Aircraft(const duckdb::unique_ptr<duckdb::DataChunk>& chunk, idx_t row);
     static const string repr(const Aircraft& ac);
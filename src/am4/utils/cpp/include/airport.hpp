@@ -2,6 +2,7 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <vector>
 #include <duckdb.hpp>
 
 using std::make_shared;
@@ -38,15 +39,16 @@ struct Airport {
         Airport::SearchType search_type;
         string search_str;
 
-        ParseResult(Airport::SearchType search_type, const string& search_str)
-            : search_type(search_type), search_str(search_str) {}
+        ParseResult(Airport::SearchType search_type, string search_str)
+            : search_type(search_type), search_str(std::move(search_str)) {}
     };
 
     struct SearchResult {
         shared_ptr<Airport> ap;
         Airport::ParseResult parse_result;
 
-        SearchResult(shared_ptr<Airport> ap, Airport::ParseResult parse_result) : ap(ap), parse_result(parse_result) {}
+        SearchResult(shared_ptr<Airport> ap, Airport::ParseResult parse_result)
+            : ap(std::move(ap)), parse_result(std::move(parse_result)) {}
     };
 
     struct Suggestion {
@@ -57,10 +59,22 @@ struct Airport {
         Suggestion(shared_ptr<Airport> ap, double score) : ap(ap), score(score) {}
     };
 
+    // one per query of search_many / suggest_many
+    struct BatchResult {
+        shared_ptr<Airport> ap;               // nullptr if not found
+        std::vector<Suggestion> suggestions;  // suggest_many only, and only if not found
+    };
+
     Airport();
     static ParseResult parse(const string& s);
+    // allocation-free for keys that fit in a short string: the result points into the database, which it keeps alive
     static SearchResult search(const string& s);
     static std::vector<Airport::Suggestion> suggest(const ParseResult& parse_result);
+    // resolves the queries in parallel on the default thread pool, results are in the order of `queries`
+    static std::vector<BatchResult> search_many(const std::vector<string>& queries);
+    static std::vector<BatchResult> suggest_many(const std::vector<string>& queries);
+    // airports with an iata, icao or a word of the name starting with `prefix` (case insensitive), largest first
+    static std::vector<shared_ptr<Airport>> autocomplete(const string& prefix, size_t n = 5);
 
     Airport(const duckdb::unique_ptr<duckdb::DataChunk>& chunk, idx_t row);
     static const string repr(const Airport& ap);
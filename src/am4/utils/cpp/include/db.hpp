@@ -1,8 +1,14 @@
 #pragma once
 #include <duckdb.hpp>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
 #include <vector>
 #include "airport.hpp"
 #include "aircraft.hpp"
+#include "ids.hpp"
+#include "snapshot.hpp"
+#include "suggest.hpp"
 
 using duckdb::Appender;
 using duckdb::Connection;
@@ -16,7 +22,6 @@ using std::string;
 
 constexpr int AIRCRAFT_COUNT = 492;
 constexpr int AIRPORT_COUNT = 3907;
-constexpr int AIRPORT_ID_MAX = 3982;
 constexpr int ROUTE_COUNT = AIRPORT_COUNT * (AIRPORT_COUNT - 1) / 2;
 
 class DatabaseException : public std::exception {
@@ -43,6 +48,77 @@ inline void VERIFY_UPDATE_SUCCESS(duckdb::unique_ptr<T> q) {
     if (!result || result->size() != 1) throw DatabaseException("FATAL: cannot update user!");
 }
 
+// typed access into a flattened chunk, skipping duckdb::Value boxing. the query must cast each column to the exact
+// physical type requested here (e.g. USMALLINT -> uint16_t, DOUBLE -> double, VARCHAR -> duckdb::string_t).
+template <typename T>
+inline T flat_value(const duckdb::unique_ptr<duckdb::DataChunk>& chunk, idx_t col, idx_t row) {
+    return duckdb::FlatVector::GetData<T>(chunk->data[col])[row];
+}
+inline string flat_string(const duckdb::unique_ptr<duckdb::DataChunk>& chunk, idx_t col, idx_t row) {
+    return flat_value<duckdb::string_t>(chunk, col, row).GetString();
+}
+
+// coarse lat/lng bucketing of the airports, used to prune candidates in spatial queries.
+// queries are conservative: every airport that could be within the requested range is visited, and callers are
+// expected to verify the exact distance themselves.
+struct AirportGrid {
+    static constexpr int CELL_DEG = 5;
+    static constexpr int LAT_CELLS = 180 / CELL_DEG;
+    static constexpr int LNG_CELLS = 360 / CELL_DEG;
+    static constexpr int CELL_COUNT = LAT_CELLS * LNG_CELLS;
+
+    // all points within `radius` km of (lat, lng) lie in [lat_lo, lat_hi] x [lng_center +- lng_half]
+    struct Window {
+        double lat_lo;
+        double lat_hi;
+        double lng_center;
+        double lng_half;  // >= 180 when the window covers every longitude
+
+        static Window around(double lat, double lng, double radius);
+        inline bool overlaps_lng(double lng_lo, double lng_hi) const {
+            if (lng_half >= 180.0) return true;
+            double d = lng_center - (lng_lo + lng_hi) / 2;
+            d -= 360.0 * std::floor((d + 180.0) / 360.0);  // wrap to [-180, 180)
+            return std::abs(d) <= lng_half + (lng_hi - lng_lo) / 2;
+        }
+    };
+
+    uint16_t cell_start[CELL_COUNT + 1];
+    uint16_t cell_airports[AIRPORT_COUNT];  // airport indices, ascending within each cell
+    uint16_t cell_max_rwy[CELL_COUNT];
+
+    static inline int cell_of(double lat, double lng) {
+        const int row = std::clamp(static_cast<int>((lat + 90.0) / CELL_DEG), 0, LAT_CELLS - 1);
+        const int col = std::clamp(static_cast<int>((lng + 180.0) / CELL_DEG), 0, LNG_CELLS - 1);
+        return row * LNG_CELLS + col;
+    }
+    void build(const Airport (&airports)[AIRPORT_COUNT]);
+
+    // calls fn(idx) for every airport in cells that intersect both windows and have a runway >= min_rwy.
+    template <typename Fn>
+    void for_each_candidate(const Window& w0, const Window& w1, uint16_t min_rwy, Fn fn) const {
+        const double lat_lo = std::max(w0.lat_lo, w1.lat_lo);
+        const double lat_hi = std::min(w0.lat_hi, w1.lat_hi);
+        if (lat_lo > lat_hi) return;
+        const int row_lo = std::clamp(static_cast<int>((lat_lo + 90.0) / CELL_DEG), 0, LAT_CELLS - 1);
+        const int row_hi = std::clamp(static_cast<int>((lat_hi + 90.0) / CELL_DEG), 0, LAT_CELLS - 1);
+        int cols[LNG_CELLS];
+        int num_cols = 0;
+        for (int col = 0; col < LNG_CELLS; col++) {
+            const double lng_lo = col * CELL_DEG - 180.0;
+            if (w0.overlaps_lng(lng_lo, lng_lo + CELL_DEG) && w1.overlaps_lng(lng_lo, lng_lo + CELL_DEG))
+                cols[num_cols++] = col;
+        }
+        for (int row = row_lo; row <= row_hi; row++) {
+            for (int c = 0; c < num_cols; c++) {
+                const int cell = row * LNG_CELLS + cols[c];
+                if (cell_max_rwy[cell] < min_rwy) continue;
+                for (uint16_t i = cell_start[cell]; i < cell_start[cell + 1]; i++) fn(cell_airports[i]);
+            }
+        }
+    }
+};
+
 // multiple threads can use the same connection?
 // https://github.com/duckdb/duckdb/blob/8c32403411d628a400cc32e5fe73df87eb5aad7d/test/api/test_api.cpp#L142
 struct Database {
@@ -50,8 +126,16 @@ struct Database {
     duckdb::unique_ptr<Connection> connection;
 
     Airport airports[AIRPORT_COUNT];                    // 1,031,448 B
-    uint16_t airport_id_hashtable[AIRPORT_ID_MAX + 1];  // 63,728 B: airport id -> airports index
+    static constexpr const std::array<uint16_t, AIRPORT_ID_MAX + 1>& airport_id_hashtable = AIRPORT_ID_TABLE;
+    // pre-normalised (uppercased) keys -> airports index, built by build_indices(). duplicated keys keep the first
+    // airport, i.e. the one a linear scan would have found.
+    std::unordered_map<string, uint16_t> airport_iata_idx;
+    std::unordered_map<string, uint16_t> airport_icao_idx;
+    std::unordered_map<string, uint16_t> airport_name_idx;
+    std::unordered_map<string, uint16_t> airport_fullname_idx;  // "NAME, COUNTRY"
     Airport get_airport_by_id(uint16_t id);
+    // index into airports, AIRPORT_COUNT if not found. key: as in ParseResult::search_str, already uppercased.
+    uint16_t find_airport_idx(Airport::SearchType type, const string& key) const;
     // note: input string are assumed to be already uppercased
     Airport get_airport_by_iata(const string& iata);
     Airport get_airport_by_icao(const string& icao);
@@ -59,13 +143,17 @@ struct Database {
     Airport get_airport_by_fullname(const string& name);
     Airport get_airport_by_all(const string& all);
 
-    template <typename ScoreFn>
-    std::vector<Airport::Suggestion> suggest_airport(const string& input, ScoreFn score_fn);
+    // fields: iata, icao, NAME, "NAME, COUNTRY", see the AIRPORT_SUGGEST_* masks
+    SuggestionIndex airport_suggestions;
+    std::vector<Airport::Suggestion> suggest_airport(const string& input, uint32_t field_mask);
     std::vector<Airport::Suggestion> suggest_airport_by_iata(const string& iata);
     std::vector<Airport::Suggestion> suggest_airport_by_icao(const string& icao);
     std::vector<Airport::Suggestion> suggest_airport_by_name(const string& name);
     std::vector<Airport::Suggestion> suggest_airport_by_fullname(const string& name);
     std::vector<Airport::Suggestion> suggest_airport_by_all(const string& all);
+    // keys: iata, icao, NAME and every word of it onwards. ranked by market, then hub cost
+    PrefixIndex airport_prefixes;
+    std::vector<shared_ptr<Airport>> autocomplete_airport(const string& prefix, size_t n);
 
     Aircraft aircrafts[AIRCRAFT_COUNT];
     static uint16_t get_aircraft_idx_by_id(uint16_t id, uint8_t priority = 0);
@@ -75,31 +163,81 @@ struct Database {
     Aircraft get_aircraft_by_name(const string& name, uint8_t priority);
     Aircraft get_aircraft_by_all(const string& all, uint8_t priority);
 
-    template <typename ScoreFn>
-    std::vector<Aircraft::Suggestion> suggest_aircraft(const string& input, ScoreFn score_fn);
+    // fields: shortname, lowercased name. only the first engine variant (priority 0) is suggested.
+    SuggestionIndex aircraft_suggestions;
+    std::vector<Aircraft::Suggestion> suggest_aircraft(const string& input, uint32_t field_mask);
     std::vector<Aircraft::Suggestion> suggest_aircraft_by_shortname(const string& shortname);
     std::vector<Aircraft::Suggestion> suggest_aircraft_by_name(const string& name);
     std::vector<Aircraft::Suggestion> suggest_aircraft_by_all(const string& all);
+    // keys: shortname, lowercased name and every word of it onwards. ranked by capacity
+    PrefixIndex aircraft_prefixes;
+    std::vector<shared_ptr<Aircraft>> autocomplete_aircraft(const string& prefix, size_t n);
+
+    AirportGrid airport_grid;  // built from `airports` during init
 
-    PaxDemand pax_demands[ROUTE_COUNT];
-    double distances[AIRPORT_COUNT][AIRPORT_COUNT];  // 96,799,832 B
+    // the large tables are views: they point either into the *_data vectors (loaded from parquet) or into the mapped
+    // snapshot, see init(use_snapshot).
+    const PaxDemand* pax_demands = nullptr;  // 45,782,226 B: triangular, indexed by get_dbroute_idx
     static inline uint32_t get_dbroute_idx(uint16_t oidx, uint16_t didx) {
         if (oidx > didx) return ((didx * (2 * AIRPORT_COUNT - didx - 1)) >> 1) + oidx - didx - 1;
         return ((oidx * (2 * AIRPORT_COUNT - oidx - 1)) >> 1) + didx - oidx - 1;
     };
 
+    // only one of the two is populated, see init(compact_distances).
+    // compact: float32 rounding moves distances by < 2 m. this occasionally shifts a ticket price by $1 or picks a
+    // different stopover among near-equal candidates, so profits agree with the dense path within 0.1%.
+    const double* distances = nullptr;         // 122,117,192 B: dense [oidx * AIRPORT_COUNT + didx]
+    const float* compact_distances = nullptr;  // 30,521,484 B: triangular, indexed by get_dbroute_idx
+    inline double get_distance(uint16_t oidx, uint16_t didx) const {
+        if (compact_distances)
+            return oidx == didx ? 0.0 : static_cast<double>(compact_distances[get_dbroute_idx(oidx, didx)]);
+        return distances[oidx * AIRPORT_COUNT + didx];
+    }
+
+    std::vector<PaxDemand> pax_demands_data;
+    std::vector<double> distances_data;
+    std::vector<float> compact_distances_data;
+    shared_ptr<const MappedFile> snapshot;
+    // points the views at the *_data vectors and drops the snapshot mapping
+    void use_owned_tables();
+
+    // returns false, leaving the database untouched, if the snapshot is missing, corrupted or out of date
+    bool load_snapshot(const string& path, bool compact_distances);
+    // route_distances: ROUTE_COUNT distances in get_dbroute_idx order. the file is written atomically.
+    void write_snapshot(const string& path, const double* route_distances) const;
+
+    // the same snapshot held in a named POSIX shared-memory segment, see init(shared_memory). unlike the file, a
+    // segment only holds the distance table of the mode it was published for: tmpfs pins every page.
+    // data_dir: where the parquet files live, used to detect a segment published from older data.
+    // PENDING: another process is still writing it. INVALID: out of date or corrupted. segment_id, if not null,
+    // receives the MappedFile::id of the segment looked at, so that only that segment is ever unlinked.
+    enum class SharedSnapshot { ATTACHED, MISSING, PENDING, INVALID };
+    SharedSnapshot attach_shared_snapshot(
+        const string& name, const string& data_dir, bool compact_distances, uint64_t* segment_id = nullptr
+    );
+    // attach_shared_snapshot, waiting up to SHARED_SNAPSHOT_TIMEOUT_MS while the segment is PENDING. a segment
+    // still pending after that is INVALID: its writer is gone.
+    SharedSnapshot await_shared_snapshot(
+        const string& name, const string& data_dir, bool compact_distances, uint64_t* segment_id = nullptr
+    );
+    // publishes the tables currently loaded and attaches to them. if another process publishes first, its segment is
+    // attached instead, once complete. an existing segment is only ever replaced after it was found INVALID, so
+    // processes starting together share one segment. throws DatabaseException if none of this works out.
+    void share_snapshot(const string& name, const string& data_dir, bool compact_distances);
+    // false, leaving it alone, if a segment of that name already exists. the header is written last.
+    bool publish_shared_snapshot(const string& name, const string& data_dir, bool compact_distances) const;
+    // validates `file` and points the tables into it
+    bool install_snapshot(shared_ptr<const MappedFile> file, const string& data_dir, bool compact_distances);
+
     static shared_ptr<Database> default_client;
     static shared_ptr<Database> Client();
     static shared_ptr<Database> Client(const string& home_dir);
 
     void populate_database();
-    void populate_internal();
-};
-
-struct CompareSuggestion {
-    bool operator()(const Airport::Suggestion& s1, const Airport::Suggestion& s2) { return s1.score > s2.score; }
-    bool operator()(const Aircraft::Suggestion& s1, const Aircraft::Suggestion& s2) { return s1.score > s2.score; }
+    // route_distances: if not null, receives the ROUTE_COUNT distances in get_dbroute_idx order, for the snapshots
+    void populate_internal(bool compact_distances = false, std::vector<double>* route_distances = nullptr);
+    void build_indices();  // the airport_*_idx maps, airport_grid and the suggestion indices
 };
 
-void init(string home_dir);
+void init(string home_dir, bool compact_distances = false, bool use_snapshot = true, string shared_memory = "");
 void _debug_query(string query);
\ No newline at end of file
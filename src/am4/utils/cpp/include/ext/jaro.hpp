@@ -14,16 +14,43 @@ const size_t JARO_WINKLER_PREFIX_SIZE = 4;
 const double JARO_WINKLER_SCALING_FACTOR = 0.1;
 const double JARO_WINKLER_BOOST_THRESHOLD = 0.7;
 
+// strings up to this length are matched with one 64-bit mask per string instead of match-flag vectors
+const size_t JARO_BITPARALLEL_MAX_SIZE = 64;
+
 #include <algorithm>
+#include <cstdint>
 #include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+inline unsigned jaro_ctz64(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline double jaro_score(size_t matchingCharacters, size_t t, size_t al, size_t bl) {
+    return (
+        JARO_WEIGHT_STRING_A * static_cast<double>(matchingCharacters) / static_cast<double>(al) +
+        JARO_WEIGHT_STRING_B * static_cast<double>(matchingCharacters) / static_cast<double>(bl) +
+        JARO_WEIGHT_TRANSPOSITIONS * (static_cast<double>(matchingCharacters) - static_cast<double>(t) / 2) /
+            static_cast<double>(matchingCharacters)
+    );
+}
 
-double jaro_distance(const std::string &a, const std::string &b) {
-    size_t al = a.size();
-    size_t bl = b.size();
+// the search window. note that for two 1-character strings `maxRange` wraps around and the window is empty, so
+// jaro("a", "a") == 0: the bit-parallel kernel keeps this so that scores never change.
+inline size_t jaro_max_range(size_t al, size_t bl) { return std::max<size_t>(0UL, std::max(al, bl) / 2 - 1); }
 
+inline double jaro_distance_scalar(const char *a, size_t al, const char *b, size_t bl) {
     if (al == 0 || bl == 0) return 0.0;
 
-    size_t maxRange = std::max<size_t>(0UL, std::max(al, bl) / 2 - 1);
+    size_t maxRange = jaro_max_range(al, bl);
 
     std::vector<bool> aMatch(al, false);
     std::vector<bool> bMatch(bl, false);
@@ -79,22 +106,14 @@ double jaro_distance(const std::string &a, const std::string &b) {
     }
 
     // Calculate Jaro distance.
-    return (
-        JARO_WEIGHT_STRING_A * static_cast<double>(matchingCharacters) / static_cast<double>(al) +
-        JARO_WEIGHT_STRING_B * static_cast<double>(matchingCharacters) / static_cast<double>(bl) +
-        JARO_WEIGHT_TRANSPOSITIONS * (static_cast<double>(matchingCharacters) - static_cast<double>(t) / 2) /
-            static_cast<double>(matchingCharacters)
-    );
+    return jaro_score(matchingCharacters, t, al, bl);
 }
 
-double jaro_winkler_distance(const std::string &a, const std::string &b) {
-    double distance = jaro_distance(a, b);
-
+inline double jaro_winkler_boost(double distance, const char *a, size_t al, const char *b, size_t bl) {
     if (distance > JARO_WINKLER_BOOST_THRESHOLD) {
         // Calculate common string prefix.
         int commonPrefix = 0;
-        for (size_t i = 0, indexEnd = std::min(std::min(a.size(), b.size()), JARO_WINKLER_PREFIX_SIZE); i < indexEnd;
-             ++i) {
+        for (size_t i = 0, indexEnd = std::min(std::min(al, bl), JARO_WINKLER_PREFIX_SIZE); i < indexEnd; ++i) {
             if (a[i] == b[i]) {
                 ++commonPrefix;
             } else {
@@ -106,4 +125,82 @@ double jaro_winkler_distance(const std::string &a, const std::string &b) {
     }
 
     return distance;
-}
\ No newline at end of file
+}
+
+// One string `a` compared against many `b`s. For a and b of up to 64 characters, bit i of a mask stands for b[i]:
+// the positions of each distinct character of a in b are gathered into one mask per character, so finding the first
+// unmatched b[i] inside the window of a[ai] is a couple of and-nots and a count trailing zeros instead of a loop over
+// the window. Matches are taken in the same greedy order as jaro_distance_scalar, so the scores are identical.
+// Longer strings fall back to jaro_distance_scalar. `a` must outlive the query.
+class JaroQuery {
+   public:
+    explicit JaroQuery(const std::string &a) : a(a.data()), al(a.size()) {
+        if (al > JARO_BITPARALLEL_MAX_SIZE) return;
+        for (size_t ai = 0; ai < al; ++ai) {
+            uint8_t &s = slot_of[static_cast<unsigned char>(a[ai])];
+            if (s == 0) s = static_cast<uint8_t>(++num_slots);
+            slots[ai] = s;
+        }
+    }
+
+    double jaro(const char *b, size_t bl) const {
+        if (al == 0 || bl == 0) return 0.0;
+        if (al > JARO_BITPARALLEL_MAX_SIZE || bl > JARO_BITPARALLEL_MAX_SIZE) return jaro_distance_scalar(a, al, b, bl);
+
+        // positions in b of every distinct character of a. masks[0] collects the characters a does not have.
+        uint64_t masks[JARO_BITPARALLEL_MAX_SIZE + 1];
+        std::fill(masks, masks + num_slots + 1, 0);
+        for (size_t bi = 0; bi < bl; ++bi) masks[slot_of[static_cast<unsigned char>(b[bi])]] |= uint64_t(1) << bi;
+
+        const size_t maxRange = jaro_max_range(al, bl);
+        uint64_t aMatch = 0, bMatch = 0;
+        size_t matchingCharacters = 0;
+        for (size_t ai = 0; ai < al; ++ai) {
+            size_t minIndex = ai > maxRange ? ai - maxRange : 0;
+            size_t maxIndex = std::min(ai + maxRange + 1, bl);
+            if (minIndex >= maxIndex) break;
+
+            const uint64_t below_max = maxIndex == 64 ? ~uint64_t(0) : (uint64_t(1) << maxIndex) - 1;
+            const uint64_t window = below_max & ~((uint64_t(1) << minIndex) - 1);
+            const uint64_t candidates = masks[slots[ai]] & window & ~bMatch;
+            if (candidates) {
+                bMatch |= candidates & (~candidates + 1);  // lowest set bit
+                aMatch |= uint64_t(1) << ai;
+                ++matchingCharacters;
+            }
+        }
+
+        if (matchingCharacters == 0) return 0.0;
+
+        // walk the matched characters of both strings in order
+        size_t t = 0;
+        for (uint64_t am = aMatch, bm = bMatch; am; am &= am - 1, bm &= bm - 1) {
+            if (a[jaro_ctz64(am)] != b[jaro_ctz64(bm)]) ++t;
+        }
+
+        return jaro_score(matchingCharacters, t, al, bl);
+    }
+
+    double jaro_winkler(const char *b, size_t bl) const { return jaro_winkler_boost(jaro(b, bl), a, al, b, bl); }
+    double jaro(const std::string &b) const { return jaro(b.data(), b.size()); }
+    double jaro_winkler(const std::string &b) const { return jaro_winkler(b.data(), b.size()); }
+
+   private:
+    const char *a;
+    size_t al;
+    size_t num_slots = 0;
+    uint8_t slot_of[256] = {};                // character -> index into masks, 0 if not in a
+    uint8_t slots[JARO_BITPARALLEL_MAX_SIZE];  // slot_of[a[ai]]
+};
+
+inline double jaro_distance(const std::string &a, const std::string &b) { return JaroQuery(a).jaro(b); }
+
+inline double jaro_winkler_distance(const std::string &a, const std::string &b) { return JaroQuery(a).jaro_winkler(b); }
+
+// scores `a` against `count` strings packed back to back in `data`: string i is data[offsets[i], offsets[i + 1]).
+inline void jaro_winkler_distance_batch(
+    const std::string &a, const char *data, const uint32_t *offsets, size_t count, double *out
+) {
+    const JaroQuery query(a);
+    for (size_t i = 0; i < count; ++i) out[i] = query.jaro_winkler(data + offsets[i], offsets[i + 1] - offsets[i]);
+}
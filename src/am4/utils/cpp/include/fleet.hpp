@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "game.hpp"
+#include "airport.hpp"
+#include "aircraft.hpp"
+#include "route.hpp"
+
+using std::vector;
+
+// Plans a fleet flying out of one origin: which candidate aircraft to buy and which routes to put them on, for the
+// highest total daily profit within an aircraft count and/or a budget.
+//
+// Unlike RoutesSearch, routes are not ranked independently: a ledger keeps the demand left on every route, and each
+// aircraft is evaluated on its own against what the aircraft already assigned to that route leave (so a route only
+// gets a second aircraft if the demand it leaves is still worth flying). The plan is built greedily with a lazy
+// priority queue of (route, aircraft) slots: an entry is only re-evaluated once it reaches the top after its route
+// changed. A local search then tries to remove each assigned aircraft, worst first, and refill the freed count, budget
+// and demand greedily, keeping the exchange only if the daily profit increases.
+class FleetPlanner {
+   public:
+    Airport origin;
+    vector<Aircraft> aircraft;  // the candidate models
+    AircraftRoute::Options options;
+    User user;
+
+    struct Assignment {
+        uint16_t aircraft_idx;  // into FleetPlanner::aircraft
+        Airport destination;
+        AircraftRoute ac_route;  // evaluated against the demand left on the route when the aircraft was assigned
+        double daily_profit;     // ac_route.profit * ac_route.trips_per_day_per_ac
+    };
+
+    struct Plan {
+        vector<Assignment> assignments;  // in the order they were made
+        double daily_profit = 0;
+        double cost = 0;  // the sum of Aircraft::cost
+    };
+
+    FleetPlanner(
+        const Airport& origin,
+        const vector<Aircraft>& aircraft,
+        const AircraftRoute::Options& options = AircraftRoute::Options(),
+        const User& user = User::Default()
+    )
+        : origin(origin), aircraft(aircraft), options(options), user(user) {}
+
+    // max_aircraft = 0 and budget = 0 mean no limit. max_exchanges: the number of assigned aircraft the local search
+    // tries to exchange, 0 to keep the greedy plan.
+    Plan get(size_t max_aircraft, double budget = 0, size_t max_exchanges = 1000) const;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time id -> index tables for the fixed airport and aircraft datasets.
+// Everything below is evaluated by the compiler, so a lookup is a single array load. When the datasets change, only
+// the source lists need to be updated.
+
+constexpr int AIRPORT_ID_MAX = 3982;
+constexpr int AIRCRAFT_ID_MAX = 377;
+// the highest id get_aircraft_by_id resolves. ids 376 and 377 are in the tables below but have never been reachable
+// by id: raising this would change what `id:` searches return.
+constexpr int AIRCRAFT_ID_SEARCH_MAX = 375;
+static_assert(AIRCRAFT_ID_SEARCH_MAX <= AIRCRAFT_ID_MAX, "aircraft id limits");
+
+// airport ids are dense except for gaps: ids in (previous breakpoint, breakpoint] map to id - (gaps so far + 1)
+constexpr uint16_t APID_BREAKPOINTS[] = {
+    52, 178, 248, 318, 538, 542, 544, 552, 558, 562, 570, 572, 577,
+    597, 1110, 1130, 1162, 1200, 1249, 1265, 1306, 1309, 1311, 1313, 1326, 1328,
+    1356, 1358, 1378, 1381, 1388, 1391, 1468, 1481, 1513, 1528, 1532, 1537, 1540,
+    1541, 1543, 1571, 1592, 1598, 1625, 1683, 1696, 2382, 2400, 2533, 2557, 2559,
+    2566, 2573, 2577, 2591, 2597, 2610, 2627, 2630, 2646, 2648, 2656, 2660, 2662,
+    2664, 2665, 2667, 2673, 3053, 3194, 3506, 3508, 3550, 3899, 3982
+};
+constexpr uint16_t MISSING_APIDS[] = {
+    52, 178, 248, 318, 538, 542, 544, 552, 558, 562, 571, 572, 577,
+    597, 1110, 1130, 1162, 1200, 1249, 1265, 1306, 1310, 1311, 1313, 1326, 1328,
+    1356, 1358, 1378, 1381, 1388, 1391, 1468, 1481, 1513, 1528, 1532, 1537, 1540,
+    1542, 1543, 1571, 1592, 1598, 1625, 1683, 1696, 2382, 2400, 2533, 2557, 2559,
+    2566, 2573, 2577, 2591, 2597, 2610, 2627, 2630, 2647, 2648, 2656, 2660, 2662,
+    2664, 2666, 2667, 2673, 3053, 3194, 3507, 3508, 3550, 3899
+};
+
+// aircraft id -> index of its first (priority 0) engine variant; the variants of an id are stored consecutively
+constexpr uint16_t ACID_FIRST_IDX[][2] = {
+    {1, 0},     {2, 4},     {3, 7},     {4, 8},     {5, 10},    {6, 12},    {7, 14},    {8, 17},    {9, 21},
+    {10, 22},   {11, 23},   {12, 24},   {13, 25},   {14, 29},   {15, 30},   {16, 32},   {17, 34},   {18, 36},
+    {19, 37},   {20, 38},   {21, 39},   {22, 41},   {23, 42},   {24, 43},   {25, 46},   {26, 47},   {27, 48},
+    {28, 49},   {29, 50},   {30, 51},   {31, 52},   {32, 53},   {33, 57},   {34, 59},   {35, 60},   {36, 61},
+    {37, 64},   {38, 66},   {39, 69},   {40, 72},   {41, 73},   {42, 74},   {43, 75},   {44, 76},   {45, 77},
+    {46, 78},   {47, 79},   {48, 81},   {49, 82},   {50, 84},   {51, 85},   {52, 89},   {53, 93},   {55, 99},
+    {56, 105},  {58, 106},  {59, 107},  {60, 108},  {61, 109},  {62, 112},  {63, 115},  {64, 118},  {66, 120},
+    {67, 122},  {68, 124},  {69, 127},  {71, 129},  {72, 133},  {73, 137},  {74, 140},  {75, 143},  {76, 146},
+    {85, 147},  {86, 148},  {87, 149},  {89, 151},  {90, 152},  {91, 153},  {92, 154},  {93, 155},  {94, 157},
+    {95, 158},  {96, 159},  {97, 160},  {99, 161},  {100, 162}, {101, 163}, {102, 164}, {103, 166}, {104, 167},
+    {105, 168}, {106, 169}, {107, 170}, {108, 171}, {109, 172}, {110, 173}, {111, 174}, {112, 175}, {113, 178},
+    {114, 180}, {115, 182}, {116, 183}, {117, 184}, {118, 185}, {119, 186}, {120, 187}, {124, 190}, {126, 191},
+    {127, 192}, {128, 193}, {129, 194}, {130, 195}, {131, 196}, {132, 197}, {133, 198}, {134, 199}, {135, 200},
+    {136, 201}, {137, 202}, {138, 203}, {139, 204}, {140, 205}, {141, 206}, {142, 207}, {143, 208}, {144, 209},
+    {145, 210}, {146, 211}, {147, 212}, {148, 213}, {149, 214}, {150, 216}, {151, 217}, {152, 218}, {153, 219},
+    {154, 220}, {155, 221}, {156, 222}, {157, 223}, {158, 224}, {159, 225}, {160, 226}, {161, 227}, {162, 228},
+    {163, 229}, {164, 230}, {165, 231}, {166, 232}, {167, 234}, {168, 235}, {169, 236}, {170, 238}, {171, 241},
+    {172, 242}, {173, 243}, {177, 246}, {178, 247}, {179, 248}, {180, 249}, {181, 250}, {182, 251}, {183, 252},
+    {184, 253}, {185, 254}, {186, 255}, {187, 256}, {189, 257}, {190, 258}, {191, 259}, {192, 260}, {193, 261},
+    {194, 262}, {195, 264}, {196, 265}, {197, 266}, {198, 267}, {199, 268}, {200, 269}, {201, 270}, {202, 272},
+    {203, 273}, {204, 274}, {205, 276}, {206, 277}, {207, 278}, {208, 279}, {209, 280}, {210, 281}, {211, 282},
+    {212, 283}, {213, 284}, {214, 285}, {215, 286}, {216, 287}, {218, 288}, {219, 289}, {220, 290}, {221, 291},
+    {222, 292}, {226, 293}, {227, 296}, {228, 299}, {229, 300}, {230, 303}, {231, 304}, {232, 305}, {233, 307},
+    {234, 309}, {241, 310}, {242, 313}, {243, 319}, {244, 320}, {245, 322}, {246, 323}, {247, 324}, {248, 325},
+    {249, 326}, {250, 328}, {251, 329}, {252, 330}, {253, 331}, {254, 332}, {255, 333}, {256, 334}, {257, 335},
+    {258, 336}, {259, 337}, {260, 338}, {266, 339}, {267, 340}, {268, 341}, {269, 343}, {270, 344}, {271, 345},
+    {272, 348}, {273, 349}, {274, 350}, {275, 351}, {276, 352}, {277, 354}, {281, 355}, {282, 356}, {283, 357},
+    {284, 358}, {285, 359}, {287, 360}, {288, 362}, {289, 363}, {290, 364}, {291, 365}, {292, 366}, {293, 367},
+    {294, 368}, {295, 369}, {298, 370}, {299, 371}, {300, 372}, {302, 374}, {303, 377}, {304, 379}, {305, 380},
+    {306, 381}, {307, 383}, {308, 384}, {309, 385}, {310, 386}, {311, 390}, {312, 394}, {313, 395}, {314, 396},
+    {315, 397}, {316, 399}, {317, 400}, {318, 401}, {320, 405}, {321, 407}, {322, 409}, {323, 413}, {324, 417},
+    {325, 418}, {326, 419}, {327, 420}, {328, 421}, {329, 422}, {330, 423}, {331, 424}, {332, 425}, {333, 426},
+    {334, 427}, {335, 428}, {336, 432}, {337, 434}, {338, 435}, {339, 436}, {340, 438}, {341, 439}, {342, 440},
+    {343, 441}, {344, 442}, {345, 443}, {346, 444}, {347, 445}, {348, 446}, {349, 447}, {350, 448}, {351, 449},
+    {352, 450}, {353, 451}, {355, 453}, {356, 454}, {357, 455}, {358, 457}, {359, 459}, {360, 460}, {361, 464},
+    {362, 468}, {363, 471}, {364, 474}, {365, 475}, {366, 477}, {367, 479}, {368, 480}, {369, 482}, {370, 483},
+    {371, 484}, {372, 485}, {373, 486}, {374, 487}, {375, 488}, {376, 489}, {377, 491}
+};
+constexpr uint16_t MISSING_ACIDS[] = {
+    54, 57, 65, 70, 77, 78, 79, 80, 81, 82, 83, 84, 88, 98, 121, 122,
+    123, 125, 174, 175, 176, 188, 217, 223, 224, 225, 235, 236, 237, 238, 239, 240,
+    261, 262, 263, 264, 265, 278, 279, 280, 286, 296, 297, 301, 319, 354
+};
+
+template <size_t N>
+struct IdBitset {
+    uint64_t words[(N + 63) / 64] = {};
+    constexpr void set(size_t i) { words[i >> 6] |= 1ULL << (i & 63); }
+    constexpr bool test(size_t i) const { return i < N && (words[i >> 6] >> (i & 63)) & 1; }
+};
+
+template <size_t N, size_t M>
+constexpr IdBitset<N> make_id_bitset(const uint16_t (&ids)[M]) {
+    IdBitset<N> bs{};
+    for (size_t i = 0; i < M; i++) bs.set(ids[i]);
+    return bs;
+}
+
+// id 0 is not a valid airport but historically resolved to index 0, which is kept
+constexpr std::array<uint16_t, AIRPORT_ID_MAX + 1> make_airport_id_table() {
+    std::array<uint16_t, AIRPORT_ID_MAX + 1> table{};
+    uint16_t start_bp = 1, offset = 1;
+    for (uint16_t bp : APID_BREAKPOINTS) {
+        for (uint16_t j = start_bp; j <= bp; j++) table[j] = j - offset;
+        offset++;
+        start_bp = bp + 1;
+    }
+    return table;
+}
+
+struct AircraftIdRange {
+    uint16_t first_idx;
+    uint16_t variants;  // 0: unknown id
+};
+
+constexpr std::array<AircraftIdRange, AIRCRAFT_ID_MAX + 1> make_aircraft_id_table(uint16_t aircraft_count) {
+    std::array<AircraftIdRange, AIRCRAFT_ID_MAX + 1> table{};
+    constexpr size_t n = sizeof(ACID_FIRST_IDX) / sizeof(ACID_FIRST_IDX[0]);
+    for (size_t i = 0; i < n; i++) {
+        const uint16_t next_idx = i + 1 < n ? ACID_FIRST_IDX[i + 1][1] : aircraft_count;
+        table[ACID_FIRST_IDX[i][0]] = {ACID_FIRST_IDX[i][1], static_cast<uint16_t>(next_idx - ACID_FIRST_IDX[i][1])};
+    }
+    return table;
+}
+
+inline constexpr auto AIRPORT_ID_TABLE = make_airport_id_table();
+inline constexpr auto MISSING_APID_SET = make_id_bitset<AIRPORT_ID_MAX + 1>(MISSING_APIDS);
+inline constexpr auto MISSING_ACID_SET = make_id_bitset<AIRCRAFT_ID_MAX + 1>(MISSING_ACIDS);
+
+static_assert(AIRPORT_ID_TABLE[1] == 0 && AIRPORT_ID_TABLE[AIRPORT_ID_MAX] == 3906, "airport id table");
+static_assert(MISSING_APID_SET.test(52) && !MISSING_APID_SET.test(53), "missing airport ids");
+static_assert(MISSING_ACID_SET.test(54) && !MISSING_ACID_SET.test(55), "missing aircraft ids");
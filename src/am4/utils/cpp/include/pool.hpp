@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::shared_ptr;
+
+// A reusable pool of native worker threads shared by the whole process.
+// Work is split into fixed-size chunks which idle workers (and the submitting thread) claim from a shared counter,
+// so a slow chunk never blocks the rest of the range. Chunk boundaries only depend on `n` and `chunk_size`, so
+// callers that write into per-chunk buffers and merge them in chunk order get deterministic results.
+class ThreadPool {
+   public:
+    // fn(chunk_idx, begin, end)
+    using ChunkFn = std::function<void(size_t, size_t, size_t)>;
+
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return num_threads; }
+    static inline size_t num_chunks(size_t n, size_t chunk_size) { return (n + chunk_size - 1) / chunk_size; }
+
+    // blocks until every chunk of [0, n) has been processed, rethrowing the first exception raised by `fn`.
+    void parallel_for(size_t n, size_t chunk_size, const ChunkFn& fn);
+
+    // the process-wide pool. defaults to 1 thread, i.e. everything runs serially on the calling thread.
+    static shared_ptr<ThreadPool> Default();
+    static void set_default_size(size_t num_threads);
+
+   private:
+    struct Job {
+        const ChunkFn* fn;
+        size_t n;
+        size_t chunk_size;
+        size_t total_chunks;
+        std::atomic<size_t> next_chunk{0};
+        std::atomic<size_t> done_chunks{0};
+        std::exception_ptr error;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        bool run_one();  // returns false once all chunks have been claimed
+    };
+
+    size_t num_threads;
+    std::vector<std::thread> workers;
+    std::deque<shared_ptr<Job>> jobs;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void worker_loop();
+
+    static shared_ptr<ThreadPool> default_pool;
+    static std::mutex default_mtx;
+};
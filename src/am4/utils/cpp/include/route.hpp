@@ -2,6 +2,10 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <limits>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
 
 #include "game.hpp"
 #include "ticket.hpp"
@@ -41,7 +45,23 @@ struct AircraftRoute {
     // TODO: decouple the options specific to the route finding to somewhere else
     struct Options {
         enum class TPDMode { AUTO = 0, STRICT_ALLOW_MULTIPLE_AC = 1, STRICT = 2 };
-        enum class SortBy { PER_TRIP = 0, PER_AC_PER_DAY = 1 };
+        // how searches rank routes, highest first. PER_FLIGHT_HOUR is the profit per trip over the flight time,
+        // PER_AC_COST the profit per aircraft per day over Aircraft::cost (the inverse of the days an aircraft takes
+        // to pay for itself), NET_OF_HUB_COST the profit per aircraft per day minus the hub cost of the origin spread
+        // over amortisation_days (only differs from PER_AC_PER_DAY when the origins differ: ReverseRoutesSearch and
+        // GlobalRoutesSearch), and WEIGHTED the sum of the other scores in sort_weights, times their weights.
+        enum class SortBy {
+            PER_TRIP = 0,
+            PER_AC_PER_DAY = 1,
+            PER_FLIGHT_HOUR = 2,
+            PER_AC_COST = 3,
+            CONTRIBUTION_PER_AC_PER_DAY = 4,
+            NET_OF_HUB_COST = 5,
+            WEIGHTED = 6
+        };
+        // MAX flies at CI 200. PROFIT and CONTRIBUTION pick the CI (0-200) of each route with the highest profit or
+        // contribution per aircraft per day: a lower CI burns less fuel and earns more contribution, but flies slower.
+        enum class CIMode { MAX = 0, PROFIT = 1, CONTRIBUTION = 2 };
         using ConfigAlgorithm =
             std::variant<std::monostate, Aircraft::PaxConfig::Algorithm, Aircraft::CargoConfig::Algorithm>;
 
@@ -51,6 +71,9 @@ struct AircraftRoute {
         float max_flight_time;
         ConfigAlgorithm config_algorithm;
         SortBy sort_by;
+        CIMode ci_mode;
+        vector<std::pair<SortBy, double>> sort_weights;  // for SortBy::WEIGHTED, which is ignored in it
+        double amortisation_days;                        // for SortBy::NET_OF_HUB_COST, 0 to ignore the hub cost
 
         Options(
             TPDMode tpd_mode = TPDMode::AUTO,
@@ -58,7 +81,10 @@ struct AircraftRoute {
             double max_distance = MAX_DISTANCE,
             float max_flight_time = 24.0f,
             ConfigAlgorithm config_algorithm = std::monostate(),
-            SortBy sort_by = SortBy::PER_TRIP
+            SortBy sort_by = SortBy::PER_TRIP,
+            CIMode ci_mode = CIMode::MAX,
+            const vector<std::pair<SortBy, double>>& sort_weights = {},
+            double amortisation_days = 365
         );
     };
     Route route;
@@ -109,7 +135,56 @@ struct AircraftRoute {
     bool valid;
     std::optional<uint16_t> max_tpd;
 
+    // The same result without any heap allocation, used by RoutesSearch for every candidate destination: warnings are
+    // a bitmask and the stopover an index into Database::airports. Full AircraftRoutes are only built from it for the
+    // destinations that are returned.
+    struct Compact {
+        static constexpr uint16_t NO_STOPOVER = std::numeric_limits<uint16_t>::max();
+
+        Route route;
+        Aircraft::Type _ac_type = Aircraft::Type::PAX;
+        Aircraft::Config config;
+        uint16_t trips_per_day_per_ac = 0;
+        Ticket ticket;
+        double max_income = 0;
+        double income = 0;
+        double fuel = 0;
+        double co2 = 0;
+        double acheck_cost = 0;
+        double repair_cost = 0;
+        double profit = 0;
+        float flight_time = 0;
+        uint16_t num_ac = 0;
+        uint8_t ci = 0;
+        float contribution = 0;
+        bool needs_stopover = false;
+        uint16_t stopover_idx = NO_STOPOVER;
+        double stopover_full_distance = 0;
+        uint16_t warnings = 0;  // bit `1 << Warning`
+        bool valid = false;
+        std::optional<uint16_t> max_tpd;
+
+        // o_idx, d_idx: distinct indices into Database::airports
+        static Compact create(
+            uint16_t o_idx, uint16_t d_idx, const Aircraft& ac, const Options& options, const User& user
+        );
+        // the same route with `pax_demand` left instead of the demand of the database, e.g. once other aircraft
+        // already fly it. cargo demand is derived from it as usual.
+        static Compact create(
+            uint16_t o_idx,
+            uint16_t d_idx,
+            const Aircraft& ac,
+            const Options& options,
+            const User& user,
+            const PaxDemand& pax_demand
+        );
+
+        inline void add_warning(Warning w) { warnings |= static_cast<uint16_t>(1u << static_cast<unsigned>(w)); }
+        inline bool has_warning(Warning w) const { return warnings & (1u << static_cast<unsigned>(w)); }
+    };
+
     AircraftRoute();
+    explicit AircraftRoute(const Compact& compact);
     static AircraftRoute create(
         const Airport& a0,
         const Airport& a1,
@@ -118,10 +193,6 @@ struct AircraftRoute {
         const User& user = User::Default()
     );
 
-    template <bool is_vip>
-    inline void update_pax_details(uint16_t ac_capacity, const AircraftRoute::Options& options, const User& user);
-    inline void update_cargo_details(uint32_t ac_capacity, const AircraftRoute::Options& options, const User& user);
-
     static inline double estimate_load(
         double reputation = 87,
         double autoprice_ratio = 1.06,
@@ -148,6 +219,56 @@ struct AircraftRoute {
     static const string repr(const AircraftRoute& acr);
 };
 
+// Process-wide cache of AircraftRoute::Stopover::find_by_efficiency results.
+// The stopover only depends on the airport pair, aircraft range, runway requirement and game mode, so it is shared by
+// every user and search. Fixed-size and direct-mapped: a colliding insert simply replaces the previous entry.
+class StopoverCache {
+   public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        size_t size;
+        size_t capacity;
+    };
+
+    static StopoverCache& Default();
+
+    static inline uint64_t make_key(
+        uint16_t o_idx, uint16_t d_idx, uint16_t range, uint16_t rwy_requirement, User::GameMode game_mode
+    ) {
+        return (1ULL << 63) | (static_cast<uint64_t>(game_mode == User::GameMode::REALISM) << 56) |
+               (static_cast<uint64_t>(rwy_requirement) << 40) | (static_cast<uint64_t>(range) << 24) |
+               (static_cast<uint64_t>(o_idx) << 12) | static_cast<uint64_t>(d_idx);
+    }
+    // airport_idx == AIRPORT_COUNT means that no stopover exists
+    bool lookup(uint64_t key, uint16_t& airport_idx, double& full_distance);
+    void insert(uint64_t key, uint16_t airport_idx, double full_distance);
+
+    void set_capacity(size_t capacity);  // 0 disables caching; also clears the cache
+    void clear();
+    Stats stats() const;
+
+   private:
+    struct Entry {
+        uint64_t key = 0;  // 0: empty
+        double full_distance;
+        uint16_t airport_idx;
+    };
+    static constexpr size_t LOCK_STRIPES = 64;
+
+    std::vector<Entry> entries;
+    mutable std::shared_mutex resize_mtx;
+    std::mutex stripe_mtx[LOCK_STRIPES];
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<size_t> size{0};
+
+    explicit StopoverCache(size_t capacity);
+    inline size_t slot_of(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) % entries.size();
+    }
+};
+
 struct Destination {
     Airport airport;
     AircraftRoute ac_route;
@@ -155,6 +276,61 @@ struct Destination {
     Destination(const Airport& destination, const AircraftRoute& route);
 };
 
+// Routes as typed, contiguous columns with one entry per route, best first: what a vector<Destination> holds, without
+// an Airport and an AircraftRoute per row. The Python bindings export every column through the buffer protocol
+// without copying it, e.g. for pyarrow. The y/j/f columns are filled for pax and vip aircraft, the l/h columns for
+// cargo aircraft, and the others are left empty.
+struct RouteColumns {
+    // strings in the Arrow utf8 layout: string i is data[offsets[i], offsets[i + 1]).
+    struct StringColumn {
+        vector<int32_t> offsets{0};
+        vector<char> data;
+
+        size_t size() const { return offsets.size() - 1; }
+        void push_back(const string& s);
+    };
+
+    vector<uint16_t> origin_id;
+    vector<uint16_t> destination_id;
+    vector<uint16_t> stopover_id;  // 0: the route needs no stopover
+    vector<double> direct_distance;
+    vector<double> full_distance;  // via the stopover, if any
+    vector<uint16_t> demand_y, demand_j, demand_f;
+    vector<uint32_t> demand_l, demand_h;
+    vector<uint16_t> config_y, config_j, config_f;
+    vector<uint8_t> config_l, config_h;
+    vector<uint16_t> ticket_y, ticket_j, ticket_f;
+    vector<float> ticket_l, ticket_h;
+    vector<float> flight_time;
+    vector<uint16_t> trips_per_day_per_ac;
+    vector<uint16_t> num_ac;
+    vector<double> max_income;
+    vector<double> income;
+    vector<double> fuel;
+    vector<double> co2;
+    vector<double> acheck_cost;
+    vector<double> repair_cost;
+    vector<double> profit;
+    vector<uint8_t> ci;
+    vector<float> contribution;
+
+    // filled from the id columns by fill_airports. the stopover strings are empty if the route needs no stopover.
+    vector<double> origin_lat, origin_lng, destination_lat, destination_lng;
+    StringColumn origin_name, origin_country, origin_iata, origin_icao;
+    StringColumn destination_name, destination_country, destination_iata, destination_icao;
+    StringColumn stopover_name, stopover_country, stopover_iata, stopover_icao;
+
+    size_t size() const { return origin_id.size(); }
+    void resize(size_t n, Aircraft::Type ac_type);
+    // the route columns of row i, from either form of the route. safe to call for different rows in parallel.
+    void set(size_t i, uint16_t o_idx, uint16_t d_idx, const AircraftRoute::Compact& ar);
+    void set(size_t i, uint16_t o_idx, uint16_t d_idx, const AircraftRoute& ar);
+    // the airport columns, once every row is set
+    void fill_airports();
+};
+
+constexpr size_t ROUTES_SEARCH_CHUNK_SIZE = 64;  // airports per unit of work in the thread pool
+
 class RoutesSearch {
    public:
     Airport origin;
@@ -162,6 +338,10 @@ class RoutesSearch {
     AircraftRoute::Options options;
     User user;
 
+    // the objectives of get_pareto_front: per aircraft per day for profit and contribution, per trip for flight time
+    // and co2. the first two are maximised, the last two minimised.
+    enum class Objective { PROFIT_PER_DAY = 0, CONTRIBUTION_PER_DAY = 1, FLIGHT_TIME = 2, CO2 = 3 };
+
     RoutesSearch(
         const Airport& origin,
         const Aircraft& aircraft,
@@ -174,5 +354,114 @@ class RoutesSearch {
         }
     }
 
-    vector<Destination> get() const;
+    // top_k = 0 returns every valid destination, otherwise only the best top_k are kept during the scan.
+    vector<Destination> get(size_t top_k = 0) const;
+
+    // the same routes as get(top_k), written straight into columns: no Destination is ever built.
+    RouteColumns get_columns(size_t top_k = 0) const;
+    // the columns of destinations found by get(), in their order
+    RouteColumns get_columns(const vector<Destination>& destinations) const;
+
+    // the destinations no other destination beats on every objective (repeated objectives are ignored), best first
+    // on the first objective, ties going to the lower airport id. every chunk of the scan keeps its own front as it
+    // goes, so dominated routes are dropped as soon as they are evaluated. throws std::invalid_argument if `objectives`
+    // is empty, as every route would then be on the front.
+    vector<Destination> get_pareto_front(
+        const vector<Objective>& objectives = {Objective::PROFIT_PER_DAY, Objective::CONTRIBUTION_PER_DAY}
+    ) const;
+};
+
+// RoutesSearch the other way round: the origins with the best routes into `destination`, ranked the same way.
+// Destination::airport is the origin of each route.
+class ReverseRoutesSearch {
+   public:
+    Airport destination;
+    Aircraft aircraft;
+    AircraftRoute::Options options;
+    User user;
+
+    ReverseRoutesSearch(
+        const Airport& destination,
+        const Aircraft& aircraft,
+        const AircraftRoute::Options& options = AircraftRoute::Options(),
+        const User& user = User::Default()
+    )
+        : destination(destination), aircraft(aircraft), options(options), user(user) {
+        if (options.max_distance > aircraft.range * 2) {
+            this->options.max_distance = aircraft.range * 2;
+        }
+    }
+
+    vector<Destination> get(size_t top_k = 0) const;
+};
+
+constexpr size_t GLOBAL_ROUTES_SEARCH_CHUNK_SIZE = 8;  // origins per unit of work: rows of the triangle get shorter
+
+// RoutesSearch from every origin at once: the best routes of the whole world for one aircraft and user.
+// The demand and distance tables are triangular and a route evaluates the same both ways, except for the runway of
+// its destination. So each pair of airports is evaluated once, for either direction whose destination runway is long
+// enough. Every chunk of origins keeps its own top k heap of (score, origin, destination). Only the final rows are
+// evaluated again, in parallel, to fill the result columns.
+class GlobalRoutesSearch {
+   public:
+    Aircraft aircraft;
+    AircraftRoute::Options options;
+    User user;
+
+    using Result = RouteColumns;
+
+    GlobalRoutesSearch(
+        const Aircraft& aircraft,
+        const AircraftRoute::Options& options = AircraftRoute::Options(),
+        const User& user = User::Default()
+    )
+        : aircraft(aircraft), options(options), user(user) {
+        if (options.max_distance > aircraft.range * 2) {
+            this->options.max_distance = aircraft.range * 2;
+        }
+    }
+
+    // ranked like RoutesSearch::get, ties going to the lower origin id, then the lower destination id. top_k = 0
+    // returns every valid route. both_directions = false lists each pair of airports once, from the lower origin id
+    // unless only the other direction is valid.
+    Result get(size_t top_k = 1000, bool both_directions = true) const;
+};
+
+constexpr size_t HUB_SEARCH_MAX_ROUTES = 100;  // routes kept per airport, i.e. the largest useful top_n
+constexpr size_t HUB_SEARCH_CACHE_SIZE = 8;    // evaluation profiles kept by HubSearch
+
+// Airports ranked as hubs: the score of an airport is the daily profit per aircraft (profit * trips_per_day_per_ac)
+// of its best top_n routes as the origin, minus its hub_cost spread over `amortisation_days`.
+// Every pair of airports is evaluated once into a triangular table, as in GlobalRoutesSearch, and every airport then
+// keeps the daily profits of its best HUB_SEARCH_MAX_ROUTES routes. Those are cached per evaluation profile (the
+// fields of the aircraft, options and user that route evaluation reads), so ranking the same profile again with
+// another top_n or amortisation, or from a new HubSearch, only has to add them up.
+class HubSearch {
+   public:
+    Aircraft aircraft;
+    AircraftRoute::Options options;
+    User user;
+
+    struct Hub {
+        Airport airport;
+        double score;
+        double routes_profit;  // the sum of the daily profits of its top_n routes
+        uint16_t num_routes;   // fewer than top_n if the airport has fewer valid routes
+    };
+
+    HubSearch(
+        const Aircraft& aircraft,
+        const AircraftRoute::Options& options = AircraftRoute::Options(),
+        const User& user = User::Default()
+    )
+        : aircraft(aircraft), options(options), user(user) {
+        if (options.max_distance > aircraft.range * 2) {
+            this->options.max_distance = aircraft.range * 2;
+        }
+    }
+
+    // best first, ties going to the lower airport id. top_n is capped at HUB_SEARCH_MAX_ROUTES. top_k = 0 returns
+    // every airport with at least one valid route.
+    vector<Hub> get(size_t top_n = 10, double amortisation_days = 365, size_t top_k = 0) const;
+    static void clear_cache();
 };
\ No newline at end of file
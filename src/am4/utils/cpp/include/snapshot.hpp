@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+
+// Binary snapshot of everything populate_internal() reads from the parquet files, so that init() can mmap the large
+// tables instead of converting ~7.6M rows through duckdb on every start.
+//
+// layout: [SnapshotHeader][section 0]...[section N-1], each section 64 B aligned.
+// PAX_DEMANDS, DISTANCES and COMPACT_DISTANCES are stored exactly as laid out in memory and used in place.
+// AIRPORTS and AIRCRAFTS hold std::strings, so they are stored as packed records and decoded into the fixed arrays.
+// the file is native-endian and not meant to be shared between machines: it is regenerated whenever it does not match
+// the running build (version, counts, byte order) or the parquet files it was written from (size, mtime).
+// the same bytes can be published into a named shared-memory segment, so that several processes on one host map a
+// single copy of the tables.
+constexpr char SNAPSHOT_MAGIC[8] = {'A', 'M', '4', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+constexpr const char* SNAPSHOT_FILENAME = "am4utils.snapshot";
+constexpr int SHARED_SNAPSHOT_TIMEOUT_MS = 10000;  // how long to wait for another process to finish publishing
+constexpr const char* SNAPSHOT_SOURCES[] = {"airports.parquet", "aircrafts.parquet", "routes.parquet"};
+constexpr size_t SNAPSHOT_SOURCE_COUNT = sizeof(SNAPSHOT_SOURCES) / sizeof(SNAPSHOT_SOURCES[0]);
+
+struct SnapshotSection {
+    enum Kind : uint32_t { AIRPORTS = 0, AIRCRAFTS, PAX_DEMANDS, DISTANCES, COMPACT_DISTANCES, COUNT };
+
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+struct SnapshotSource {
+    uint64_t size;
+    int64_t mtime;
+
+    bool operator==(const SnapshotSource& o) const { return size == o.size && mtime == o.mtime; }
+    bool operator!=(const SnapshotSource& o) const { return !(*this == o); }
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t airport_count;
+    uint32_t aircraft_count;
+    uint32_t route_count;
+    uint32_t pax_demand_size;  // sizeof(PaxDemand)
+    SnapshotSource sources[SNAPSHOT_SOURCE_COUNT];
+    SnapshotSection sections[SnapshotSection::COUNT];
+    uint64_t header_checksum;  // of every byte above
+};
+
+// read-only mapping of a whole file or named POSIX shared-memory segment, unmapped on destruction
+class MappedFile {
+   public:
+    explicit MappedFile(const string& path, bool shared_memory = false);  // throws DatabaseException
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return len; }
+    uint64_t id() const { return ino; }  // the inode of the file or segment, 0 if unknown
+
+   private:
+    const uint8_t* ptr = nullptr;
+    size_t len = 0;
+    uint64_t ino = 0;
+#ifdef _WIN32
+    std::vector<uint8_t> buffer;
+#endif
+};
+
+// fast non-cryptographic checksum, only meant to catch truncated or corrupted files
+uint64_t snapshot_checksum(const void* data, size_t size);
+
+// size and mtime of the parquet files in data_dir; missing files are all zeroes
+void snapshot_sources(const string& data_dir, SnapshotSource (&sources)[SNAPSHOT_SOURCE_COUNT]);
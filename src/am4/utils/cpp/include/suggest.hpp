@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using std::string;
+
+// Top-k fuzzy matching over a fixed set of records, each with a few pre-normalised search strings ("fields").
+// The score of a record is the max jaro_winkler_distance(input, field) over the queried fields, exactly as a linear
+// scan would compute it; ties are broken by record order.
+//
+// Instead of scoring every record, a trigram inverted index first picks the records sharing the most trigrams with
+// the input to establish a k-th best score. Every other record is then only scored if an upper bound of its score
+// (from its character multiset overlap with the input, the lengths and the common prefix) could still beat it, so the
+// result is identical to the brute-force scan.
+class SuggestionIndex {
+   public:
+    static constexpr size_t MAX_FIELDS = 4;
+    static constexpr size_t HIST_BUCKETS = 64;
+
+    struct Hit {
+        uint16_t record;
+        double score;
+    };
+
+    // fields[f][r]: normalised field f of record r. records with `enabled[r] == false` are never suggested.
+    void build(const std::vector<std::vector<string>>& fields, const std::vector<bool>& enabled);
+    // field_mask: bit f set to query field f
+    std::vector<Hit> top(const string& input, uint32_t field_mask, size_t k = 5) const;
+
+   private:
+    using Histogram = std::array<uint8_t, HIST_BUCKETS>;
+
+    size_t num_records = 0;
+    size_t num_fields = 0;
+    std::vector<std::vector<string>> fields;      // [field][record]
+    std::vector<std::vector<Histogram>> hists;    // [field][record]
+    std::vector<uint16_t> enabled_records;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;  // trigram -> record * MAX_FIELDS + field
+
+    static Histogram histogram(const string& s);
+    template <typename Fn>
+    static void for_each_trigram(const string& s, Fn fn);
+    static double upper_bound(const string& input, const Histogram& input_hist, const string& s, const Histogram& h);
+};
+
+// Top-n completions of a prefix, ranked by a static per-record rank (e.g. airport market) rather than by similarity,
+// so that it is cheap enough to run on every keystroke. Keys are sorted, so the keys starting with a prefix are one
+// contiguous range found by binary search. A record matching through several keys is returned once.
+class PrefixIndex {
+   public:
+    // keys[r]: the pre-normalised keys of record r. ties in rank are broken by record order.
+    void build(
+        const std::vector<std::vector<string>>& keys, const std::vector<uint64_t>& rank, const std::vector<bool>& enabled
+    );
+    std::vector<uint16_t> complete(const string& prefix, size_t n = 5) const;
+
+   private:
+    struct Entry {
+        string key;
+        uint16_t record;
+    };
+
+    std::vector<Entry> entries;      // sorted by key
+    std::vector<uint64_t> ranks;     // [record]
+    std::vector<uint16_t> by_rank;   // enabled records, best first: the completions of the empty prefix
+};
@@ -1,18 +1,23 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <cctype>
 #include <cstdint>
-#include <stdexcept>
 
-inline bool str_to_uint16(const std::string& str, uint16_t& out) {
-    try {
-        std::size_t pos;
-        int i = std::stoi(str, &pos);
-        if (i < 0 || i > 65535) throw std::out_of_range("out of range");
-        if (pos != str.size()) throw std::invalid_argument("trailing");
-        out = static_cast<uint16_t>(i);
-        return true;
-    } catch (std::invalid_argument&) {
-    } catch (std::out_of_range&) {
+// accepts what std::stoi would, without the exceptions: it runs on every search, mostly for non-numeric input
+inline bool str_to_uint16(std::string_view str, uint16_t& out) {
+    size_t i = 0;
+    while (i < str.size() && std::isspace(static_cast<unsigned char>(str[i]))) i++;
+    bool negative = false;
+    if (i < str.size() && (str[i] == '+' || str[i] == '-')) negative = str[i++] == '-';
+    if (i == str.size()) return false;
+    uint32_t value = 0;
+    for (; i < str.size(); i++) {
+        if (!std::isdigit(static_cast<unsigned char>(str[i]))) return false;
+        value = value * 10 + static_cast<uint32_t>(str[i] - '0');
+        if (value > 65535) return false;
     }
-    return false;
+    if (negative && value != 0) return false;
+    out = static_cast<uint16_t>(value);
+    return true;
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <atomic>
+#include <thread>
 
 #include <ittnotify.h>
 
@@ -15,8 +17,10 @@
 #include "include/airport.hpp"
 #include "include/aircraft.hpp"
 #include "include/route.hpp"
+#include "include/pool.hpp"
 
 #include "include/log.hpp"
+#include "include/ext/jaro.hpp"
 
 using std::cerr;
 using std::cout;
@@ -63,6 +67,27 @@ class Timer {
     }
 };
 
+// tpd_sweep stacking aircraft on a route one at a time, as the reference for the search it does instead
+template <typename Cfg, typename CalcCfgFn, typename CalcIncomeFn>
+uint16_t stack_one_by_one(
+    double tpdpa, double income_loss_tol, CalcCfgFn calc_cfg, CalcIncomeFn calc_income, Cfg& cfg, double& max_income
+) {
+    cfg = calc_cfg(tpdpa);
+    max_income = calc_income(cfg);
+    const double max_income_bnd = max_income * (1 - income_loss_tol);
+    uint16_t num_ac = 1;
+    for (uint16_t i = 2; i < 200; i++) {
+        const Cfg i_cfg = calc_cfg(tpdpa * i);
+        if (!i_cfg.valid) break;
+        const double i_max_income = calc_income(i_cfg);
+        if (i_max_income < max_income_bnd) break;
+        cfg = i_cfg;
+        max_income = i_max_income;
+        num_ac = i;
+    }
+    return num_ac;
+}
+
 int64_t to_int64(const TimePoint& time_point) {
     using namespace std::chrono;
     return duration_cast<microseconds>(time_point.time_since_epoch()).count();
@@ -76,8 +101,126 @@ int main() {
          << std::setprecision(15) << endl;
 
     try {
-        init(executable_path);  // 1.3s
-        // const auto& db = Database::Client();
+        cout << "init (parquet) ";
+        auto init_timer = Timer();
+        init(executable_path, false, false);
+        init_timer.stop();
+        cout << "init (snapshot) ";
+        init_timer = Timer();
+        init(executable_path);
+        init_timer.stop();
+        const auto& db = Database::Client();
+
+        // routes.parquet through the previous loader, which boxed every cell in a duckdb::Value, against the flat
+        // column reads of populate_internal. both read into scratch buffers, the database is left alone.
+        {
+            std::vector<PaxDemand> pax_demands(ROUTE_COUNT), flat_pax_demands(ROUTE_COUNT);
+            std::vector<double> distances(ROUTE_COUNT), flat_distances(ROUTE_COUNT);
+            cout << "routes.parquet (GetValue) ";
+            auto load_timer = Timer();
+            auto result = db->connection->Query("SELECT yd, jd, fd, d FROM read_parquet('~/data/routes.parquet');");
+            CHECK_SUCCESS_REF(result);
+            idx_t i = 0;
+            while (auto chunk = result->Fetch()) {
+                for (idx_t j = 0; j < chunk->size() && i < ROUTE_COUNT; j++, i++) {
+                    pax_demands[i] = PaxDemand(
+                        chunk->GetValue(0, j).GetValue<uint16_t>(), chunk->GetValue(1, j).GetValue<uint16_t>(),
+                        chunk->GetValue(2, j).GetValue<uint16_t>()
+                    );
+                    distances[i] = chunk->GetValue(3, j).GetValue<double>();
+                }
+            }
+            load_timer.stop();
+
+            cout << "routes.parquet (FlatVector) ";
+            load_timer = Timer();
+            result = db->connection->Query(
+                "SELECT yd::USMALLINT, jd::USMALLINT, fd::USMALLINT, d::DOUBLE "
+                "FROM read_parquet('~/data/routes.parquet');"
+            );
+            CHECK_SUCCESS_REF(result);
+            i = 0;
+            while (auto chunk = result->Fetch()) {
+                chunk->Flatten();
+                const idx_t n = std::min<idx_t>(chunk->size(), ROUTE_COUNT - i);
+                const uint16_t* yd = duckdb::FlatVector::GetData<uint16_t>(chunk->data[0]);
+                const uint16_t* jd = duckdb::FlatVector::GetData<uint16_t>(chunk->data[1]);
+                const uint16_t* fd = duckdb::FlatVector::GetData<uint16_t>(chunk->data[2]);
+                const double* d = duckdb::FlatVector::GetData<double>(chunk->data[3]);
+                for (idx_t j = 0; j < n; j++) flat_pax_demands[i + j] = PaxDemand(yd[j], jd[j], fd[j]);
+                std::copy(d, d + n, flat_distances.begin() + static_cast<std::ptrdiff_t>(i));
+                i += n;
+            }
+            load_timer.stop();
+            size_t num_mismatches = 0;
+            for (idx_t k = 0; k < i; k++) {
+                const PaxDemand &a = pax_demands[k], &b = flat_pax_demands[k];
+                if (a.y != b.y || a.j != b.j || a.f != b.f || distances[k] != flat_distances[k]) num_mismatches++;
+            }
+            cout << "  " << i << " rows, " << num_mismatches << " mismatches" << endl;
+        }
+
+        // jaro-winkler kernels: one query against every airport name, 100 times
+        {
+            std::vector<string> names;
+            string packed;
+            std::vector<uint32_t> offsets = {0};
+            for (const Airport& ap : db->airports) {
+                names.push_back(ap.name);
+                std::transform(names.back().begin(), names.back().end(), names.back().begin(), ::toupper);
+                packed += names.back();
+                offsets.push_back(static_cast<uint32_t>(packed.size()));
+            }
+            const string query = "INTERNATONAL AIRPRT";
+            std::vector<double> scores(names.size());
+            double checksum[3] = {};
+
+            cout << "jaro_winkler (scalar) ";
+            auto jaro_timer = Timer();
+            for (int k = 0; k < 100; k++)
+                for (const string& name : names)
+                    checksum[0] += jaro_winkler_boost(
+                        jaro_distance_scalar(query.data(), query.size(), name.data(), name.size()), query.data(),
+                        query.size(), name.data(), name.size()
+                    );
+            jaro_timer.stop();
+            cout << "jaro_winkler (bit-parallel) ";
+            jaro_timer = Timer();
+            for (int k = 0; k < 100; k++)
+                for (const string& name : names) checksum[1] += jaro_winkler_distance(query, name);
+            jaro_timer.stop();
+            cout << "jaro_winkler (batch) ";
+            jaro_timer = Timer();
+            for (int k = 0; k < 100; k++) {
+                jaro_winkler_distance_batch(query, packed.data(), offsets.data(), names.size(), scores.data());
+                for (double score : scores) checksum[2] += score;
+            }
+            jaro_timer.stop();
+            if (checksum[0] != checksum[1] || checksum[0] != checksum[2]) cerr << "jaro_winkler: scores differ" << endl;
+        }
+
+        // autocomplete: every 10th airport typed out one keystroke at a time, by iata and by name
+        {
+            size_t keystrokes = 0, completions = 0;
+            double worst_us = 0;
+            cout << "autocomplete ";
+            auto autocomplete_timer = Timer();
+            for (size_t i = 0; i < AIRPORT_COUNT; i += 10) {
+                for (const string* typed : {&db->airports[i].iata, &db->airports[i].name}) {
+                    for (size_t len = 1; len <= typed->size(); len++) {
+                        const auto start = std::chrono::high_resolution_clock::now();
+                        completions += Airport::autocomplete(typed->substr(0, len), 10).size();
+                        const std::chrono::duration<double, std::micro> elapsed =
+                            std::chrono::high_resolution_clock::now() - start;
+                        worst_us = std::max(worst_us, elapsed.count());
+                        keystrokes++;
+                    }
+                }
+            }
+            autocomplete_timer.stop();
+            cout << "  " << keystrokes << " keystrokes, " << completions << " completions, worst " << worst_us
+                 << " us" << endl;
+        }
 
         Airport ap0 = *Airport::search("BAH").ap;
         Airport ap1 = *Airport::search("GMR").ap;
@@ -96,6 +239,175 @@ int main() {
         timer.stop();
         // getchar();
 
+        // every 40th origin against all destinations: dispatching on the aircraft type, game mode and tpd mode for
+        // every destination (Compact::create) against once per search (RoutesSearch, on the default single thread pool)
+        {
+            size_t num_routes[2] = {};
+            cout << "routes (dispatch per destination) ";
+            auto routes_timer = Timer();
+            for (uint16_t o_idx = 0; o_idx < AIRPORT_COUNT; o_idx += 40) {
+                for (uint16_t d_idx = 0; d_idx < AIRPORT_COUNT; d_idx++) {
+                    if (d_idx == o_idx) continue;
+                    if (AircraftRoute::Compact::create(o_idx, d_idx, ac, options, user).valid) num_routes[0]++;
+                }
+            }
+            routes_timer.stop();
+            cout << "routes (dispatch per search) ";
+            routes_timer = Timer();
+            for (uint16_t o_idx = 0; o_idx < AIRPORT_COUNT; o_idx += 40)
+                num_routes[1] += RoutesSearch(db->airports[o_idx], ac, options, user).get().size();
+            routes_timer.stop();
+            cout << "  " << num_routes[0] << " / " << num_routes[1] << " valid routes" << endl;
+        }
+
+        // the same searches with a pax aircraft, seats ordered by distance class (AUTO) against all six orders (BEST)
+        {
+            const Aircraft pax_ac = *Aircraft::search("b744").ac;
+            for (const auto alg : {Aircraft::PaxConfig::Algorithm::AUTO, Aircraft::PaxConfig::Algorithm::BEST}) {
+                auto pax_options = AircraftRoute::Options(AircraftRoute::Options::TPDMode::AUTO);
+                pax_options.config_algorithm = alg;
+                double max_income = 0;
+                cout << (alg == Aircraft::PaxConfig::Algorithm::BEST ? "routes (BEST) " : "routes (AUTO) ");
+                auto routes_timer = Timer();
+                for (uint16_t o_idx = 0; o_idx < AIRPORT_COUNT; o_idx += 40) {
+                    for (const auto& dest : RoutesSearch(db->airports[o_idx], pax_ac, pax_options, user).get())
+                        max_income += dest.ac_route.max_income;
+                }
+                routes_timer.stop();
+                cout << "  total max income " << max_income << endl;
+            }
+        }
+
+        // the same searches at CI 200 against the most profitable CI of every route
+        {
+            using CIMode = AircraftRoute::Options::CIMode;
+            for (const auto ci_mode : {CIMode::MAX, CIMode::PROFIT}) {
+                auto ci_options = options;
+                ci_options.ci_mode = ci_mode;
+                double daily_profit = 0;
+                cout << (ci_mode == CIMode::MAX ? "routes (CI 200) " : "routes (CI by profit) ");
+                auto routes_timer = Timer();
+                for (uint16_t o_idx = 0; o_idx < AIRPORT_COUNT; o_idx += 40) {
+                    for (const auto& dest : RoutesSearch(db->airports[o_idx], ac, ci_options, user).get())
+                        daily_profit += dest.ac_route.profit * dest.ac_route.trips_per_day_per_ac;
+                }
+                routes_timer.stop();
+                cout << "  total daily profit " << daily_profit << endl;
+            }
+        }
+
+        // the routes no other route beats on profit, contribution and flight time at once
+        {
+            using Objective = RoutesSearch::Objective;
+            const vector<Objective> objectives = {
+                Objective::PROFIT_PER_DAY, Objective::CONTRIBUTION_PER_DAY, Objective::FLIGHT_TIME
+            };
+            size_t front_size = 0;
+            cout << "pareto fronts ";
+            auto pareto_timer = Timer();
+            for (uint16_t o_idx = 0; o_idx < AIRPORT_COUNT; o_idx += 40)
+                front_size += RoutesSearch(db->airports[o_idx], ac, options, user).get_pareto_front(objectives).size();
+            pareto_timer.stop();
+            cout << "  " << front_size << " routes on the fronts" << endl;
+        }
+
+        // the top 1000 routes of the whole world, on every core
+        {
+            ThreadPool::set_default_size(std::max(1u, std::thread::hardware_concurrency()));
+            cout << "global routes (" << ThreadPool::Default()->size() << " threads) ";
+            auto global_timer = Timer();
+            const auto top = GlobalRoutesSearch(ac, options, user).get(1000);
+            global_timer.stop();
+            // the first ranking scans every pair, the second one only re-sums the cached routes
+            for (const size_t top_n : {10, 30}) {
+                cout << "hubs (top " << top_n << " routes) ";
+                auto hub_timer = Timer();
+                HubSearch(ac, options, user).get(top_n, 365, 10);
+                hub_timer.stop();
+            }
+            ThreadPool::set_default_size(1);
+            if (top.size() != 0)
+                cout << "  best: " << top.origin_id[0] << " -> " << top.destination_id[0] << ", profit "
+                     << top.profit[0] << endl;
+        }
+
+        // every route of the dataset: stacking aircraft one at a time must give the same number of aircraft, config and
+        // max income as tpd_sweep
+        {
+            ThreadPool::set_default_size(std::max(1u, std::thread::hardware_concurrency()));
+            std::atomic<size_t> num_checked{0}, num_mismatches{0};
+            cout << "stacking check ";
+            auto stacking_timer = Timer();
+            for (const string shortname : {"c172", "b744", "a32vip", "b722f"}) {
+                const Aircraft stack_ac = *Aircraft::search(shortname).ac;
+                ThreadPool::Default()->parallel_for(AIRPORT_COUNT, 16, [&](size_t, size_t begin, size_t end) {
+                    for (uint16_t o_idx = static_cast<uint16_t>(begin); o_idx < end; o_idx++) {
+                        for (uint16_t d_idx = 0; d_idx < AIRPORT_COUNT; d_idx++) {
+                            if (d_idx == o_idx) continue;
+                            const auto ar = AircraftRoute::Compact::create(o_idx, d_idx, stack_ac, options, user);
+                            if (!ar.valid) continue;
+                            const double tpdpa = ar.trips_per_day_per_ac;
+                            double max_income;
+                            uint16_t num_ac;
+                            bool same_config;
+                            if (stack_ac.type == Aircraft::Type::CARGO) {
+                                const CargoDemand load_adj_cd = CargoDemand(ar.route.pax_demand);
+                                const CargoTicket& tkt = get<CargoTicket>(ar.ticket);
+                                Aircraft::CargoConfig cfg;
+                                num_ac = stack_one_by_one(
+                                    tpdpa, user.income_loss_tol,
+                                    [&](double tpd) {
+                                        return Aircraft::CargoConfig::calc_cargo_conf(
+                                            load_adj_cd / user.load / tpd, stack_ac.capacity, user.l_training,
+                                            user.h_training
+                                        );
+                                    },
+                                    [&](const Aircraft::CargoConfig& c) {
+                                        return static_cast<uint32_t>(
+                                            ((1 + user.l_training / 100.0) * c.l * 0.7 * tkt.l +
+                                             (1 + user.h_training / 100.0) * c.h * tkt.h) *
+                                            stack_ac.capacity / 100.0
+                                        );
+                                    },
+                                    cfg, max_income
+                                );
+                                const auto& got = get<Aircraft::CargoConfig>(ar.config);
+                                same_config = cfg.l == got.l && cfg.h == got.h;
+                            } else {
+                                const PaxDemand load_adj_pd = ar.route.pax_demand / user.load;
+                                const bool is_vip = stack_ac.type == Aircraft::Type::VIP;
+                                const uint16_t ty = is_vip ? get<VIPTicket>(ar.ticket).y : get<PaxTicket>(ar.ticket).y;
+                                const uint16_t tj = is_vip ? get<VIPTicket>(ar.ticket).j : get<PaxTicket>(ar.ticket).j;
+                                const uint16_t tf = is_vip ? get<VIPTicket>(ar.ticket).f : get<PaxTicket>(ar.ticket).f;
+                                Aircraft::PaxConfig cfg;
+                                num_ac = stack_one_by_one(
+                                    tpdpa, user.income_loss_tol,
+                                    [&](double tpd) {
+                                        return Aircraft::PaxConfig::calc_pax_conf(
+                                            load_adj_pd / tpd, static_cast<uint16_t>(stack_ac.capacity),
+                                            ar.route.direct_distance, user.game_mode
+                                        );
+                                    },
+                                    [&](const Aircraft::PaxConfig& c) -> uint32_t {
+                                        return c.y * ty + c.j * tj + c.f * tf;
+                                    },
+                                    cfg, max_income
+                                );
+                                const auto& got = get<Aircraft::PaxConfig>(ar.config);
+                                same_config = cfg.y == got.y && cfg.j == got.j && cfg.f == got.f;
+                            }
+                            num_checked++;
+                            if (!same_config || num_ac != ar.num_ac || max_income != ar.max_income) num_mismatches++;
+                        }
+                    }
+                });
+            }
+            stacking_timer.stop();
+            ThreadPool::set_default_size(1);
+            cout << "  " << num_checked << " routes, " << num_mismatches << " mismatches" << endl;
+            if (num_mismatches != 0) return 1;
+        }
+
     } catch (DatabaseException& e) {
         cerr << "DatabaseException: " << e.what() << endl;
         return 1;
@@ -0,0 +1,108 @@
+#include <algorithm>
+
+#include "include/pool.hpp"
+
+shared_ptr<ThreadPool> ThreadPool::default_pool = nullptr;
+std::mutex ThreadPool::default_mtx;
+
+ThreadPool::ThreadPool(size_t num_threads) : num_threads(std::max<size_t>(num_threads, 1)) {
+    // the submitting thread always participates, so we only need n - 1 background workers
+    for (size_t i = 1; i < this->num_threads; i++) {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+bool ThreadPool::Job::run_one() {
+    const size_t chunk = next_chunk.fetch_add(1);
+    if (chunk >= total_chunks) return false;
+
+    const size_t begin = chunk * chunk_size;
+    const size_t end = std::min(begin + chunk_size, n);
+    try {
+        (*fn)(chunk, begin, end);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!error) error = std::current_exception();
+    }
+    if (done_chunks.fetch_add(1) + 1 == total_chunks) {
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty()) return;
+            job = jobs.front();
+        }
+        if (!job->run_one()) {
+            // every chunk is claimed: retire the job so that we can move on to the next one
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!jobs.empty() && jobs.front() == job) jobs.pop_front();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t n, size_t chunk_size, const ChunkFn& fn) {
+    if (n == 0) return;
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    const size_t total_chunks = num_chunks(n, chunk_size);
+
+    if (workers.empty() || total_chunks == 1) {
+        for (size_t chunk = 0; chunk < total_chunks; chunk++) {
+            const size_t begin = chunk * chunk_size;
+            fn(chunk, begin, std::min(begin + chunk_size, n));
+        }
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->n = n;
+    job->chunk_size = chunk_size;
+    job->total_chunks = total_chunks;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        jobs.push_back(job);
+    }
+    cv.notify_all();
+
+    while (job->run_one()) {
+    }
+    {
+        std::unique_lock<std::mutex> lock(job->mtx);
+        job->cv.wait(lock, [&] { return job->done_chunks.load() == job->total_chunks; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        jobs.erase(std::remove(jobs.begin(), jobs.end(), job), jobs.end());
+    }
+    if (job->error) std::rethrow_exception(job->error);
+}
+
+shared_ptr<ThreadPool> ThreadPool::Default() {
+    std::lock_guard<std::mutex> lock(default_mtx);
+    if (!default_pool) default_pool = std::make_shared<ThreadPool>(1);
+    return default_pool;
+}
+
+// searches that are still running keep their reference to the old pool until they finish
+void ThreadPool::set_default_size(size_t num_threads) {
+    std::lock_guard<std::mutex> lock(default_mtx);
+    if (default_pool && default_pool->size() == std::max<size_t>(num_threads, 1)) return;
+    default_pool = std::make_shared<ThreadPool>(num_threads);
+}
@@ -1,10 +1,19 @@
 #include <math.h>
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <cmath>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
 
 #include "include/route.hpp"
 #include "include/db.hpp"
+#include "include/pool.hpp"
 
 using std::get;
 
@@ -20,7 +29,7 @@ Route Route::create(const Airport& ap1, const Airport& ap2) {
 
     Route route;
     route.pax_demand = db->pax_demands[db->get_dbroute_idx(o_idx, d_idx)];
-    route.direct_distance = db->distances[o_idx][d_idx];
+    route.direct_distance = db->get_distance(o_idx, d_idx);
     route.valid = true;
     return route;
 }
@@ -38,31 +47,48 @@ inline double Route::calc_distance(const Airport& ap1, const Airport& ap2) {
     return calc_distance(ap1.lat, ap1.lng, ap2.lat, ap2.lng);
 }
 
-template <typename Cfg>
+constexpr double MAX_NUM_AC = 200;  // exclusive upper bound of the aircraft stacked on a route by tpd_sweep
+
+inline bool same_config(const Aircraft::PaxConfig& a, const Aircraft::PaxConfig& b) {
+    return a.y == b.y && a.j == b.j && a.f == b.f;
+}
+inline bool same_config(const Aircraft::CargoConfig& a, const Aircraft::CargoConfig& b) {
+    return a.l == b.l && a.h == b.h;
+}
+
+// the callables are template parameters rather than std::function, which would allocate for their captures.
+// same_run(tpd, cfg): true if calc_cfg(tpd) is known to give the valid config `cfg` of a single aircraft. it must hold
+// for a prefix of the stacked aircraft only, i.e. once false for some tpd it is false for every larger one.
+template <AircraftRoute::Options::TPDMode tpd_mode, typename Cfg, typename EstMaxTpdFn, typename CalcCfgFn,
+          typename CalcMaxIncomeFn, typename SameRunFn>
 void tpd_sweep(
     const User& user,
     const AircraftRoute::Options& options,
-    std::function<double()> est_max_tpd,
-    std::function<Cfg(double)> calc_cfg,
-    std::function<uint32_t(const Cfg&)> calc_max_income,
-    AircraftRoute* ar
+    EstMaxTpdFn est_max_tpd,
+    CalcCfgFn calc_cfg,
+    CalcMaxIncomeFn calc_max_income,
+    SameRunFn same_run,
+    AircraftRoute::Compact* ar
 ) {
+    using TPDMode = AircraftRoute::Options::TPDMode;
     // first, calculate the configuration for 1 aircraft
     double tpdpa = static_cast<double>(options.trips_per_day_per_ac);
-    if (options.tpd_mode == AircraftRoute::Options::TPDMode::AUTO) {
+    if constexpr (tpd_mode == TPDMode::AUTO) {
         tpdpa = std::min(floor(24. / static_cast<double>(ar->flight_time)), floor(est_max_tpd()));
     }
     Cfg cfg = calc_cfg(tpdpa);
-    if (options.tpd_mode != AircraftRoute::Options::TPDMode::AUTO && !cfg.valid) {
-        ar->warnings.push_back(AircraftRoute::Warning::ERR_INSUFFICIENT_DEMAND);
-        ar->valid = false;
-        return;
+    if constexpr (tpd_mode != TPDMode::AUTO) {
+        if (!cfg.valid) {
+            ar->add_warning(AircraftRoute::Warning::ERR_INSUFFICIENT_DEMAND);
+            ar->valid = false;
+            return;
+        }
     }
     // it's possible that the est_max_tpd() is still too high due to precision issues (though very unlikely)
     while (!cfg.valid) {
         tpdpa--;
         if (tpdpa <= 0) {
-            ar->warnings.push_back(AircraftRoute::Warning::ERR_INSUFFICIENT_DEMAND);
+            ar->add_warning(AircraftRoute::Warning::ERR_INSUFFICIENT_DEMAND);
             ar->valid = false;
             return;
         }
@@ -70,7 +96,7 @@ void tpd_sweep(
     }
 
     double max_income = calc_max_income(cfg);
-    if (options.tpd_mode == AircraftRoute::Options::TPDMode::STRICT) {
+    if constexpr (tpd_mode == TPDMode::STRICT) {
         ar->config = cfg;
         ar->max_income = max_income;
         ar->income = max_income * user.load;
@@ -95,7 +121,31 @@ void tpd_sweep(
     double max_income_bnd = max_income * (1 - user.income_loss_tol);
 
     double num_ac = 1;
-    for (double i_num_ac = num_ac + 1; i_num_ac < 200; i_num_ac++) {
+    /*
+    Aircraft stacked with the config of a single aircraft earn the same income and are all accepted, so the end of that
+    run is found with a galloping binary search over same_run instead of one aircraft at a time. Past it, aircraft are
+    added one by one as before.
+    */
+    if (max_income >= max_income_bnd) {
+        auto unchanged = [&](double i) { return same_run(tpdpa * i, cfg); };
+        double lo = 1, hi = MAX_NUM_AC;  // unchanged(lo), !unchanged(hi)
+        for (double step = 1; lo + step < hi; step *= 2) {
+            if (!unchanged(lo + step)) {
+                hi = lo + step;
+                break;
+            }
+            lo += step;
+        }
+        while (hi - lo > 1) {
+            const double mid = floor((lo + hi) / 2);
+            if (unchanged(mid))
+                lo = mid;
+            else
+                hi = mid;
+        }
+        num_ac = lo;
+    }
+    for (double i_num_ac = num_ac + 1; i_num_ac < MAX_NUM_AC; i_num_ac++) {
         const auto i_cfg = calc_cfg(tpdpa * i_num_ac);
         if (!i_cfg.valid) break;
 
@@ -115,68 +165,441 @@ void tpd_sweep(
     ar->max_tpd = std::nullopt;
 }
 
-// TODO: use one template function for both pax and cargo
-template <bool is_vip>
-inline void AircraftRoute::update_pax_details(
-    uint16_t ac_capacity, const AircraftRoute::Options& options, const User& user
+// the stopover with the shortest total distance. airport_idx: AircraftRoute::Compact::NO_STOPOVER if there is none.
+static void find_stopover(
+    uint16_t o_idx,
+    uint16_t d_idx,
+    const Aircraft& aircraft,
+    User::GameMode game_mode,
+    uint16_t& airport_idx,
+    double& full_distance
 ) {
-    const Aircraft::PaxConfig::Algorithm config_algorithm =
-        std::holds_alternative<std::monostate>(options.config_algorithm)
-            ? Aircraft::PaxConfig::Algorithm::AUTO
-            : get<Aircraft::PaxConfig::Algorithm>(options.config_algorithm);
-    const PaxDemand load_adj_pd = this->route.pax_demand / user.load;
-    auto est_max_tpd = [&]() -> double {
-        return static_cast<double>(load_adj_pd.y + load_adj_pd.j * 2 + load_adj_pd.f * 3) /
-               static_cast<double>(ac_capacity);
-    };
-    auto calc_cfg = [&](double tpd) {
-        return Aircraft::PaxConfig::calc_pax_conf(
-            load_adj_pd / tpd, ac_capacity, this->route.direct_distance, user.game_mode, config_algorithm
-        );
-    };
+    const auto& db = Database::Client();
+    const auto& airports = db->airports;
+    uint16_t candidate_idx = AIRPORT_COUNT;
+    double candidate_distance = 99999;
 
-    const auto tkt = [&]() {
-        if constexpr (is_vip)
-            return VIPTicket::from_optimal(this->route.direct_distance, user.game_mode);
-        else
-            return PaxTicket::from_optimal(this->route.direct_distance, user.game_mode);
-    }();
-    auto calc_max_income = [&](const Aircraft::PaxConfig& cfg) -> uint32_t {
-        return (cfg.y * tkt.y + cfg.j * tkt.j + cfg.f * tkt.f);
-    };
-    tpd_sweep<Aircraft::PaxConfig>(user, options, est_max_tpd, calc_cfg, calc_max_income, this);
-    this->ticket = tkt;
+    const double ac_range = static_cast<double>(aircraft.range);
+    const uint16_t rwy_requirement = game_mode == User::GameMode::EASY ? 0 : aircraft.rwy;
+
+    StopoverCache& cache = StopoverCache::Default();
+    const uint64_t cache_key = StopoverCache::make_key(o_idx, d_idx, aircraft.range, rwy_requirement, game_mode);
+    if (!cache.lookup(cache_key, candidate_idx, candidate_distance)) {
+        const auto w_o = AirportGrid::Window::around(airports[o_idx].lat, airports[o_idx].lng, ac_range);
+        const auto w_d = AirportGrid::Window::around(airports[d_idx].lat, airports[d_idx].lng, ac_range);
+        // d_o & d_d will catch cases where idx == o_idx || idx == d_idx
+        // cells are not visited in index order: ties are broken towards the lowest index, like a linear scan would.
+        db->airport_grid.for_each_candidate(w_o, w_d, rwy_requirement, [&](uint16_t idx) {
+            if (airports[idx].rwy < rwy_requirement) return;
+            const double d_o = db->get_distance(o_idx, idx);
+            if (d_o > ac_range || d_o < 100.0) return;
+            const double d_d = db->get_distance(d_idx, idx);
+            if (d_d > ac_range || d_d < 100.0) return;
+            const double full_distance = d_o + d_d;
+            if (full_distance < candidate_distance || (full_distance == candidate_distance && idx < candidate_idx)) {
+                candidate_idx = idx;
+                candidate_distance = full_distance;
+            }
+        });
+        cache.insert(cache_key, candidate_idx, candidate_distance);
+    }
+    airport_idx = candidate_idx == AIRPORT_COUNT ? AircraftRoute::Compact::NO_STOPOVER : candidate_idx;
+    full_distance = candidate_distance;
 }
 
-inline void AircraftRoute::update_cargo_details(
-    uint32_t ac_capacity, const AircraftRoute::Options& options, const User& user
-) {
-    const Aircraft::CargoConfig::Algorithm config_algorithm =
-        std::holds_alternative<std::monostate>(options.config_algorithm)
-            ? Aircraft::CargoConfig::Algorithm::AUTO
-            : get<Aircraft::CargoConfig::Algorithm>(options.config_algorithm);
-    const CargoDemand load_adj_cd = CargoDemand(this->route.pax_demand);
-
-    auto est_max_tpd = [&]() -> double {
-        double k_h = 1. + static_cast<double>(user.h_training) / 100;
-        double k_l = 1. + static_cast<double>(user.l_training) / 100;
-        return (
-            ((k_h / k_l / 0.7) * static_cast<double>(load_adj_cd.l) +
-             static_cast<double>(load_adj_cd.h) / (k_h * static_cast<double>(ac_capacity)))
+// cost index (CI) 0-200: the factors of the speed, fuel and co2 relative to CI 200
+constexpr size_t CI_COUNT = 201;
+template <typename T, typename Fn>
+constexpr std::array<T, CI_COUNT> make_ci_table(Fn fn) {
+    std::array<T, CI_COUNT> table{};
+    for (size_t ci = 0; ci < CI_COUNT; ci++) table[ci] = fn(static_cast<int>(ci));
+    return table;
+}
+constexpr auto CI_SPEED = make_ci_table<float>([](int ci) { return static_cast<float>(35 * ci + 3000) / 10000.0f; });
+constexpr auto CI_FUEL = make_ci_table<double>([](int ci) { return ci / 500.0 + 0.6; });
+constexpr auto CI_CO2 = make_ci_table<double>([](int ci) { return ci / 2000.0 + 0.9; });
+
+// The evaluation behind AircraftRoute::Compact::create, specialised at compile time on the aircraft type, game mode and
+// tpd mode. Everything that only depends on the aircraft, options and user is resolved once in the constructor, so
+// that RoutesSearch can dispatch once and then evaluate every destination without branching on any of them.
+template <Aircraft::Type ac_type, User::GameMode game_mode, AircraftRoute::Options::TPDMode tpd_mode>
+class RouteKernel {
+   public:
+    using Compact = AircraftRoute::Compact;
+    static constexpr bool is_easy = game_mode == User::GameMode::EASY;
+
+    RouteKernel(const Aircraft& ac, const AircraftRoute::Options& options, const User& user)
+        : db(Database::Client()),
+          ac(ac),
+          options(options),
+          user(user),
+          speed(ac.speed * (is_easy ? 1.5f : 1.0f)),
+          max_flight_time_per_trip(24.0f / static_cast<float>(options.trips_per_day_per_ac)),
+          check_cost(static_cast<float>(ac.check_cost * (is_easy ? 0.5 : 1.0))),
+          maint(static_cast<float>(ac.maint)),
+          repair_cost(
+              ac.cost / 1000.0 * 0.0075 * (1 - 2 * user.repair_training / 100.0)
+          ),  // each flight adds random [0, 1.5]% wear, each tp decreases wear by 2%
+          k_l(1. + static_cast<double>(user.l_training) / 100),
+          k_h(1. + static_cast<double>(user.h_training) / 100) {
+        if constexpr (ac_type == Aircraft::Type::CARGO) {
+            cargo_algorithm = std::holds_alternative<std::monostate>(options.config_algorithm)
+                                  ? Aircraft::CargoConfig::Algorithm::AUTO
+                                  : get<Aircraft::CargoConfig::Algorithm>(options.config_algorithm);
+        } else {
+            pax_algorithm = std::holds_alternative<std::monostate>(options.config_algorithm)
+                                ? Aircraft::PaxConfig::Algorithm::AUTO
+                                : get<Aircraft::PaxConfig::Algorithm>(options.config_algorithm);
+        }
+    }
+
+    // o_idx, d_idx: distinct indices into Database::airports
+    Compact operator()(uint16_t o_idx, uint16_t d_idx) const {
+        return (*this)(o_idx, d_idx, db->pax_demands[db->get_dbroute_idx(o_idx, d_idx)]);
+    }
+
+    Compact operator()(uint16_t o_idx, uint16_t d_idx, const PaxDemand& pax_demand) const {
+        Compact acr;
+        acr.route.pax_demand = pax_demand;
+        acr.route.direct_distance = db->get_distance(o_idx, d_idx);
+        acr.route.valid = true;
+        acr._ac_type = ac_type;
+        acr.max_tpd = std::nullopt;
+
+        if constexpr (game_mode == User::GameMode::REALISM) {
+            if (db->airports[d_idx].rwy < ac.rwy) {
+                acr.add_warning(AircraftRoute::Warning::ERR_RWY_TOO_SHORT);
+                return acr;
+            }
+        }
+        if (acr.route.direct_distance > options.max_distance) {
+            acr.add_warning(AircraftRoute::Warning::ERR_DISTANCE_ABOVE_SPECIFIED);
+            return acr;
+        } else if (acr.route.direct_distance > 2 * ac.range) {
+            acr.add_warning(AircraftRoute::Warning::ERR_DISTANCE_TOO_LONG);
+            return acr;
+        } else if (acr.route.direct_distance < 100) {
+            acr.add_warning(AircraftRoute::Warning::ERR_DISTANCE_TOO_SHORT);
+            return acr;
+        } else if (acr.route.direct_distance < 1000) {
+            acr.add_warning(AircraftRoute::Warning::REDUCED_CONTRIBUTION);
+        }
+        acr.needs_stopover = acr.route.direct_distance > ac.range;
+        if (acr.needs_stopover) {
+            find_stopover(o_idx, d_idx, ac, game_mode, acr.stopover_idx, acr.stopover_full_distance);
+            if (acr.stopover_idx == Compact::NO_STOPOVER) {
+                acr.add_warning(AircraftRoute::Warning::ERR_NO_STOPOVER);
+                return acr;
+            }
+        }
+        const double full_distance = acr.needs_stopover ? acr.stopover_full_distance : acr.route.direct_distance;
+        acr.flight_time = static_cast<float>(full_distance) / speed;
+        if (acr.flight_time > options.max_flight_time) {
+            acr.add_warning(AircraftRoute::Warning::ERR_FLIGHT_TIME_ABOVE_SPECIFIED);
+            return acr;
+        }
+        if constexpr (tpd_mode != AircraftRoute::Options::TPDMode::AUTO) {
+            if (acr.flight_time > max_flight_time_per_trip) {
+                acr.add_warning(AircraftRoute::Warning::ERR_TRIPS_PER_DAY_TOO_HIGH);
+                return acr;
+            }
+        }
+        update_details(acr);
+        if (!acr.valid) return acr;
+        acr.ci = 200;
+        if (options.ci_mode != AircraftRoute::Options::CIMode::MAX) optimise_ci(acr, full_distance);
+        update_costs(acr, full_distance);
+
+        acr.valid = true;
+        return acr;
+    }
+
+   private:
+    const shared_ptr<Database> db;
+    const Aircraft& ac;
+    const AircraftRoute::Options& options;
+    const User& user;
+    Aircraft::PaxConfig::Algorithm pax_algorithm = Aircraft::PaxConfig::Algorithm::AUTO;
+    Aircraft::CargoConfig::Algorithm cargo_algorithm = Aircraft::CargoConfig::Algorithm::AUTO;
+    const float speed;
+    const float max_flight_time_per_trip;
+    const float check_cost;
+    const float maint;
+    const double repair_cost;
+    const double k_l, k_h;  // cargo training multipliers
+
+    inline void update_details(Compact& acr) const {
+        if constexpr (ac_type == Aircraft::Type::CARGO)
+            update_cargo_details(acr);
+        else
+            update_pax_details(acr);
+    }
+
+    // the costs of one trip with the config and cost index of acr
+    inline void update_costs(Compact& acr, double full_distance) const {
+        if constexpr (ac_type == Aircraft::Type::CARGO) {
+            acr.co2 = AircraftRoute::calc_co2(ac, get<Aircraft::CargoConfig>(acr.config), full_distance, user, acr.ci);
+        } else {
+            acr.co2 = AircraftRoute::calc_co2(ac, get<Aircraft::PaxConfig>(acr.config), full_distance, user, acr.ci);
+        }
+        acr.fuel = AircraftRoute::calc_fuel(ac, full_distance, user, acr.ci);
+        acr.acheck_cost = check_cost * ceil(acr.flight_time * (is_easy ? 1.5 : 1.0)) / maint;
+        acr.repair_cost = repair_cost;
+        acr.profit =
+            (acr.income - acr.fuel * user.fuel_price / 1000.0 - acr.co2 * user.co2_price / 1000.0 - acr.acheck_cost -
+             acr.repair_cost);
+        acr.contribution = AircraftRoute::calc_contribution(full_distance, user, acr.ci);
+    }
+
+    // an upper bound of the income of one trip with any config: the whole capacity in the most lucrative class
+    inline double income_bound(const Compact& acr) const {
+        const double capacity = static_cast<double>(ac.capacity);
+        if constexpr (ac_type == Aircraft::Type::CARGO) {
+            const auto& tkt = get<CargoTicket>(acr.ticket);
+            return std::max(k_l * 0.7 * tkt.l, k_h * tkt.h) * capacity * user.load;
+        } else {
+            const PaxTicket tkt = [&]() -> PaxTicket {
+                if constexpr (ac_type == Aircraft::Type::VIP)
+                    return get<VIPTicket>(acr.ticket);
+                else
+                    return get<PaxTicket>(acr.ticket);
+            }();
+            return std::max({tkt.y / 1.0, tkt.j / 2.0, tkt.f / 3.0}) * capacity * user.load;
+        }
+    }
+
+    /*
+    Replaces the CI 200 of acr, already swept at CI 200, with the one of the highest profit (or contribution, ties going
+    to profit, then to the lower CI) per aircraft per day. The speed is scaled by 0.3 + 0.0035 * CI, while fuel, co2
+    and contribution are linear in it.
+
+    The config only depends on the CI through the trips per day: with the STRICT modes they are fixed, and only the CIs
+    that fit them are feasible. With AUTO, the sweep starts at the trips the flight time allows, capped by the demand,
+    so every CI that still allows the trips found at CI 200 lands on the same config. Lower CIs fall in bands of fewer
+    trips, contiguous since the flight time only grows as the CI decreases, and each band is swept at most once.
+
+    Within a band, fuel and co2 only grow with the CI and contribution only shrinks, while the A-check cost drops by
+    whole hours of flight time: the best CI is the lowest one of the band or of one of these hours. The 201 CIs thus
+    boil down to a handful of candidates, and the bands whose bound cannot beat the best so far are not swept at all.
+    */
+    inline void optimise_ci(Compact& acr, double full_distance) const {
+        using TPDMode = AircraftRoute::Options::TPDMode;
+        const bool by_profit = options.ci_mode == AircraftRoute::Options::CIMode::PROFIT;
+        const float distance = static_cast<float>(full_distance);
+        constexpr double hours_mult = is_easy ? 1.5 : 1.0;
+        auto flight_time = [&](size_t ci) { return distance / (speed * CI_SPEED[ci]); };
+        auto hours = [&](size_t ci) { return ceil(flight_time(ci) * hours_mult); };  // billed by the A-check
+        auto time_tpd = [&](size_t ci) { return floor(24. / static_cast<double>(flight_time(ci))); };
+
+        // the lowest CI in [lo, 200] that fits, CI_COUNT if none. fits() must only turn true as the CI increases, which
+        // happens around a flight time of max_flight_time.
+        auto lowest_ci = [&](size_t lo, double max_flight_time, auto fits) -> size_t {
+            if (!fits(CI_COUNT - 1)) return CI_COUNT;
+            const double est = std::ceil((full_distance / (speed * max_flight_time) - 0.3) / 0.0035);
+            size_t ci = static_cast<size_t>(std::clamp(est, static_cast<double>(lo), CI_COUNT - 1.0));
+            while (ci > lo && fits(ci - 1)) ci--;
+            while (!fits(ci)) ci++;
+            return ci;
+        };
+        auto feasible = [&](size_t ci) {
+            const float ft = flight_time(ci);
+            if (ft > options.max_flight_time) return false;
+            if constexpr (tpd_mode == TPDMode::AUTO)
+                return time_tpd(ci) >= 1;
+            else
+                return ft <= max_flight_time_per_trip;
+        };
+        const float max_ft = tpd_mode == TPDMode::AUTO ? 24.0f : max_flight_time_per_trip;
+        const size_t ci_lo = lowest_ci(0, std::min(options.max_flight_time, max_ft), feasible);
+        if (ci_lo == CI_COUNT) return;
+
+        const double fuel = AircraftRoute::calc_fuel(ac, full_distance, user);  // at CI 200, where the factor is 1
+        auto fuel_cost = [&](size_t ci) { return fuel * CI_FUEL[ci] * user.fuel_price / 1000.0; };
+        auto acheck_cost = [&](size_t ci) { return check_cost * hours(ci) / maint; };
+        auto contribution = [&](size_t ci) {
+            return AircraftRoute::calc_contribution(full_distance, user, static_cast<uint8_t>(ci));
+        };
+
+        Compact best = acr;
+        double best_primary = -std::numeric_limits<double>::infinity(), best_secondary = best_primary;
+        auto consider = [&](const Compact& band, double co2, size_t ci) {
+            const double tpd = static_cast<double>(band.trips_per_day_per_ac);
+            const double profit =
+                (band.income - fuel_cost(ci) - co2 * CI_CO2[ci] * user.co2_price / 1000.0 - acheck_cost(ci) -
+                 repair_cost) *
+                tpd;
+            const double contrib = contribution(ci) * tpd;
+            const double primary = by_profit ? profit : contrib;
+            const double secondary = by_profit ? contrib : profit;
+            if (primary < best_primary) return;
+            if (primary == best_primary) {
+                if (secondary < best_secondary) return;
+                if (secondary == best_secondary && ci > best.ci) return;
+            }
+            best_primary = primary;
+            best_secondary = secondary;
+            best = band;
+            best.ci = static_cast<uint8_t>(ci);
+        };
+        // the lowest CI of the band and of every hour of flight time less within it
+        auto evaluate_band = [&](const Compact& band, size_t lo, size_t hi) {
+            double co2;
+            if constexpr (ac_type == Aircraft::Type::CARGO)
+                co2 = AircraftRoute::calc_co2(ac, get<Aircraft::CargoConfig>(band.config), full_distance, user);
+            else
+                co2 = AircraftRoute::calc_co2(ac, get<Aircraft::PaxConfig>(band.config), full_distance, user);
+            for (size_t ci = lo; ci <= hi;) {
+                consider(band, co2, ci);
+                const double h = hours(ci) - 1;
+                if (h < 1) break;
+                ci = lowest_ci(ci + 1, h / hours_mult, [&](size_t c) { return hours(c) <= h; });
+            }
+        };
+
+        if constexpr (tpd_mode == TPDMode::AUTO) {
+            struct Band {
+                size_t lo, hi;
+                double tpd, bound;
+            };
+            const double tpd_200 = static_cast<double>(acr.trips_per_day_per_ac);
+            const double income_max = income_bound(acr);
+            std::vector<Band> bands;
+            for (size_t hi = CI_COUNT - 1;;) {
+                const double tpd = std::min(time_tpd(hi), tpd_200);
+                auto fits = [&](size_t ci) { return time_tpd(ci) >= tpd; };
+                const size_t lo = std::max(ci_lo, lowest_ci(ci_lo, 24. / tpd, fits));
+                if (tpd == tpd_200) {
+                    evaluate_band(acr, lo, hi);
+                } else {
+                    // the sweep never flies more trips than the flight time allows, and co2 is left out
+                    const double bound = by_profit ? (income_max - fuel_cost(lo) - acheck_cost(hi) - repair_cost) * tpd
+                                                   : contribution(lo) * tpd;
+                    bands.push_back({lo, hi, tpd, bound});
+                }
+                if (lo == ci_lo) break;
+                hi = lo - 1;
+            }
+            // the most promising first, until no other band can beat the best so far
+            std::sort(bands.begin(), bands.end(), [](const Band& a, const Band& b) { return a.bound > b.bound; });
+            for (const Band& b : bands) {
+                if (b.bound < best_primary) break;
+                Compact band = acr;
+                band.flight_time = flight_time(b.hi);
+                update_details(band);
+                if (band.valid) evaluate_band(band, b.lo, b.hi);
+            }
+        } else {
+            evaluate_band(acr, ci_lo, CI_COUNT - 1);
+        }
+        if (best.ci == acr.ci) return;
+        best.flight_time = flight_time(best.ci);
+        if constexpr (tpd_mode == TPDMode::STRICT) update_details(best);  // max_tpd depends on the flight time
+        acr = best;
+    }
+
+    // TODO: use one template function for both pax and cargo
+    inline void update_pax_details(Compact& acr) const {
+        const uint16_t ac_capacity = static_cast<uint16_t>(ac.capacity);
+        const PaxDemand load_adj_pd = acr.route.pax_demand / user.load;
+        const double distance = acr.route.direct_distance;
+        auto est_max_tpd = [&]() -> double {
+            return static_cast<double>(load_adj_pd.y + load_adj_pd.j * 2 + load_adj_pd.f * 3) /
+                   static_cast<double>(ac_capacity);
+        };
+
+        const auto tkt = [&]() {
+            if constexpr (ac_type == Aircraft::Type::VIP)
+                return VIPTicket::from_optimal(distance, game_mode);
+            else
+                return PaxTicket::from_optimal(distance, game_mode);
+        }();
+        const PaxTicket prices = tkt;
+        const bool best = pax_algorithm == Aircraft::PaxConfig::Algorithm::BEST;
+        auto calc_cfg = [&](double tpd) {
+            if (best) return Aircraft::PaxConfig::calc_best_conf(load_adj_pd / tpd, ac_capacity, prices);
+            return Aircraft::PaxConfig::calc_pax_conf(
+                load_adj_pd / tpd, ac_capacity, distance, game_mode, pax_algorithm
+            );
+        };
+        auto calc_max_income = [&](const Aircraft::PaxConfig& cfg) -> uint32_t {
+            return (cfg.y * tkt.y + cfg.j * tkt.j + cfg.f * tkt.f);
+        };
+        // the demand per flight never increases as aircraft are added, and each greedy seat fill is monotone in it:
+        // once the config changes or becomes invalid, it never comes back. which order is the best one can change
+        // back and forth though, so BEST only keeps its config for sure while every class has more demand than it
+        // could ever get seats: then all six orders fill the same seats and stay valid.
+        auto same_run = [&](double tpd, const Aircraft::PaxConfig& cfg) {
+            if (best) {
+                const PaxDemand d_pf = load_adj_pd / tpd;
+                return d_pf.y > ac_capacity && d_pf.j > ac_capacity / 2 && d_pf.f > ac_capacity / 3;
+            }
+            const auto i_cfg = calc_cfg(tpd);
+            return i_cfg.valid && same_config(i_cfg, cfg);
+        };
+        tpd_sweep<tpd_mode, Aircraft::PaxConfig>(
+            user, options, est_max_tpd, calc_cfg, calc_max_income, same_run, &acr
         );
-    };
-    auto calc_cfg = [&](double trips_per_day) {
-        return Aircraft::CargoConfig::calc_cargo_conf(
-            load_adj_cd / user.load / trips_per_day, ac_capacity, user.l_training, user.h_training, config_algorithm
+        acr.ticket = tkt;
+    }
+
+    inline void update_cargo_details(Compact& acr) const {
+        const uint32_t ac_capacity = ac.capacity;
+        const CargoDemand load_adj_cd = CargoDemand(acr.route.pax_demand);
+
+        auto est_max_tpd = [&]() -> double {
+            return (
+                ((k_h / k_l / 0.7) * static_cast<double>(load_adj_cd.l) +
+                 static_cast<double>(load_adj_cd.h) / (k_h * static_cast<double>(ac_capacity)))
+            );
+        };
+        auto calc_cfg = [&](double trips_per_day) {
+            return Aircraft::CargoConfig::calc_cargo_conf(
+                load_adj_cd / user.load / trips_per_day, ac_capacity, user.l_training, user.h_training, cargo_algorithm
+            );
+        };
+        const CargoTicket tkt = CargoTicket::from_optimal(acr.route.direct_distance, game_mode);
+        // truncated to whole dollars, like the pax income
+        auto calc_income = [&](const Aircraft::CargoConfig& cfg) -> uint32_t {
+            return static_cast<uint32_t>(
+                ((1 + user.l_training / 100.0) * cfg.l * 0.7 * tkt.l + (1 + user.h_training / 100.0) * cfg.h * tkt.h) *
+                ac_capacity / 100.0
+            );
+        };
+        // the l / h split is monotone in the demand per flight, which never increases as aircraft are added
+        auto same_run = [&](double trips_per_day, const Aircraft::CargoConfig& cfg) {
+            const auto i_cfg = calc_cfg(trips_per_day);
+            return i_cfg.valid && same_config(i_cfg, cfg);
+        };
+        tpd_sweep<tpd_mode, Aircraft::CargoConfig>(
+            user, options, est_max_tpd, calc_cfg, calc_income, same_run, &acr
         );
+        acr.ticket = tkt;
+    }
+};
+
+// calls fn(kernel) with the RouteKernel matching the aircraft type, game mode and tpd mode
+template <typename Fn>
+static auto with_route_kernel(const Aircraft& ac, const AircraftRoute::Options& options, const User& user, Fn fn) {
+    using Type = Aircraft::Type;
+    using GameMode = User::GameMode;
+    using TPDMode = AircraftRoute::Options::TPDMode;
+
+    auto by_tpd_mode = [&](auto type, auto game_mode) {
+        constexpr Type t = decltype(type)::value;
+        constexpr GameMode g = decltype(game_mode)::value;
+        if (options.tpd_mode == TPDMode::AUTO) return fn(RouteKernel<t, g, TPDMode::AUTO>(ac, options, user));
+        if (options.tpd_mode == TPDMode::STRICT_ALLOW_MULTIPLE_AC)
+            return fn(RouteKernel<t, g, TPDMode::STRICT_ALLOW_MULTIPLE_AC>(ac, options, user));
+        return fn(RouteKernel<t, g, TPDMode::STRICT>(ac, options, user));
     };
-    const CargoTicket tkt = CargoTicket::from_optimal(this->route.direct_distance, user.game_mode);
-    auto calc_income = [&](const Aircraft::CargoConfig& cfg) -> double {
-        return ((1 + user.l_training / 100.0) * cfg.l * 0.7 * tkt.l + (1 + user.h_training / 100.0) * cfg.h * tkt.h) *
-               ac_capacity / 100.0;
+    auto by_game_mode = [&](auto type) {
+        if (user.game_mode == GameMode::EASY)
+            return by_tpd_mode(type, std::integral_constant<GameMode, GameMode::EASY>());
+        return by_tpd_mode(type, std::integral_constant<GameMode, GameMode::REALISM>());
     };
-    tpd_sweep<Aircraft::CargoConfig>(user, options, est_max_tpd, calc_cfg, calc_income, this);
-    this->ticket = tkt;
+    if (ac.type == Type::PAX) return by_game_mode(std::integral_constant<Type, Type::PAX>());
+    if (ac.type == Type::CARGO) return by_game_mode(std::integral_constant<Type, Type::CARGO>());
+    return by_game_mode(std::integral_constant<Type, Type::VIP>());
 }
 
 AircraftRoute::AircraftRoute() : valid(false){};
@@ -186,94 +609,79 @@ AircraftRoute::Options::Options(
     double max_distance,
     float max_flight_time,
     ConfigAlgorithm config_algorithm,
-    SortBy sort_by
+    SortBy sort_by,
+    CIMode ci_mode,
+    const vector<std::pair<SortBy, double>>& sort_weights,
+    double amortisation_days
 )
     : tpd_mode(tpd_mode),
       trips_per_day_per_ac(trips_per_day_per_ac),
       max_distance(max_distance),
       max_flight_time(max_flight_time),
       config_algorithm(config_algorithm),
-      sort_by(sort_by) {
+      sort_by(sort_by),
+      ci_mode(ci_mode),
+      sort_weights(sort_weights),
+      amortisation_days(amortisation_days) {
     if (tpd_mode == AircraftRoute::Options::TPDMode::AUTO && trips_per_day_per_ac != 1)
         std::cerr << "WARN: trips_per_day_per_ac is ignored when tpd_mode is AUTO" << std::endl;
 };
 AircraftRoute AircraftRoute::create(
     const Airport& a0, const Airport& a1, const Aircraft& ac, const AircraftRoute::Options& options, const User& user
 ) {
-    AircraftRoute acr;
-    acr.route = Route::create(a0, a1);
-    acr._ac_type = ac.type;
-    acr.max_tpd = std::nullopt;
+    if (a0.id == a1.id) throw SameOdException();
+    const auto& db = Database::Client();
+    return AircraftRoute(
+        Compact::create(db->airport_id_hashtable[a0.id], db->airport_id_hashtable[a1.id], ac, options, user)
+    );
+}
 
-    if (user.game_mode == User::GameMode::REALISM && a1.rwy < ac.rwy) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_RWY_TOO_SHORT);
-        return acr;
-    }
-    if (acr.route.direct_distance > options.max_distance) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_DISTANCE_ABOVE_SPECIFIED);
-        return acr;
-    } else if (acr.route.direct_distance > 2 * ac.range) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_DISTANCE_TOO_LONG);
-        return acr;
-    } else if (acr.route.direct_distance < 100) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_DISTANCE_TOO_SHORT);
-        return acr;
-    } else if (acr.route.direct_distance < 1000) {
-        acr.warnings.push_back(AircraftRoute::Warning::REDUCED_CONTRIBUTION);
+// warnings are only ever added in increasing enum order, so expanding the bitmask keeps their order
+AircraftRoute::AircraftRoute(const Compact& c)
+    : route(c.route),
+      _ac_type(c._ac_type),
+      config(c.config),
+      trips_per_day_per_ac(c.trips_per_day_per_ac),
+      ticket(c.ticket),
+      max_income(c.max_income),
+      income(c.income),
+      fuel(c.fuel),
+      co2(c.co2),
+      acheck_cost(c.acheck_cost),
+      repair_cost(c.repair_cost),
+      profit(c.profit),
+      flight_time(c.flight_time),
+      num_ac(c.num_ac),
+      ci(c.ci),
+      contribution(c.contribution),
+      needs_stopover(c.needs_stopover),
+      stopover(
+          c.stopover_idx == Compact::NO_STOPOVER
+              ? Stopover()
+              : Stopover(Database::Client()->airports[c.stopover_idx], c.stopover_full_distance)
+      ),
+      valid(c.valid),
+      max_tpd(c.max_tpd) {
+    for (unsigned w = 0; w <= static_cast<unsigned>(Warning::ERR_TRIPS_PER_DAY_TOO_HIGH); w++) {
+        if (c.warnings & (1u << w)) warnings.push_back(static_cast<Warning>(w));
     }
-    acr.needs_stopover = acr.route.direct_distance > ac.range;
-    acr.stopover = acr.needs_stopover ? Stopover::find_by_efficiency(a0, a1, ac, user.game_mode) : Stopover();
-    if (acr.needs_stopover && !acr.stopover.exists) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_NO_STOPOVER);
-        return acr;
-    }
-    const double full_distance = acr.stopover.exists ? acr.stopover.full_distance : acr.route.direct_distance;
-    acr.flight_time =
-        static_cast<float>(full_distance) / (ac.speed * (user.game_mode == User::GameMode::EASY ? 1.5f : 1.0f));
-    if (acr.flight_time > options.max_flight_time) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_FLIGHT_TIME_ABOVE_SPECIFIED);
-        return acr;
-    }
-    if (options.tpd_mode != Options::TPDMode::AUTO &&
-        acr.flight_time > 24.0f / static_cast<float>(options.trips_per_day_per_ac)) {
-        acr.warnings.push_back(AircraftRoute::Warning::ERR_TRIPS_PER_DAY_TOO_HIGH);
-        return acr;
-    }
-    switch (ac.type) {
-        case Aircraft::Type::PAX: {
-            acr.update_pax_details<false>(static_cast<uint16_t>(ac.capacity), options, user);
-            if (!acr.valid) return acr;
-            acr.co2 = AircraftRoute::calc_co2(ac, get<Aircraft::PaxConfig>(acr.config), full_distance, user);
-            break;
-        }
-        case Aircraft::Type::CARGO: {
-            acr.update_cargo_details(static_cast<uint32_t>(ac.capacity), options, user);
-            if (!acr.valid) return acr;
-            acr.co2 = AircraftRoute::calc_co2(ac, get<Aircraft::CargoConfig>(acr.config), full_distance, user);
-            break;
-        }
-        case Aircraft::Type::VIP: {
-            acr.update_pax_details<true>(static_cast<uint16_t>(ac.capacity), options, user);
-            if (!acr.valid) return acr;
-            acr.co2 = AircraftRoute::calc_co2(ac, get<Aircraft::PaxConfig>(acr.config), full_distance, user);
-            break;
-        }
-    }
-    acr.fuel = AircraftRoute::calc_fuel(ac, full_distance, user);
-    acr.acheck_cost = static_cast<float>(ac.check_cost * (user.game_mode == User::GameMode::EASY ? 0.5 : 1.0)) *
-                      ceil(acr.flight_time * (user.game_mode == User::GameMode::EASY ? 1.5 : 1.0)) /
-                      static_cast<float>(ac.maint);
-    acr.repair_cost =
-        ac.cost / 1000.0 * 0.0075 *
-        (1 - 2 * user.repair_training / 100.0);  // each flight adds random [0, 1.5]% wear, each tp decreases wear by 2%
-    acr.profit =
-        (acr.income - acr.fuel * user.fuel_price / 1000.0 - acr.co2 * user.co2_price / 1000.0 - acr.acheck_cost -
-         acr.repair_cost);
-    acr.ci = 200;
-    acr.contribution = AircraftRoute::calc_contribution(full_distance, user, 200);
+}
 
-    acr.valid = true;
-    return acr;
+AircraftRoute::Compact AircraftRoute::Compact::create(
+    uint16_t o_idx, uint16_t d_idx, const Aircraft& ac, const AircraftRoute::Options& options, const User& user
+) {
+    return with_route_kernel(ac, options, user, [&](const auto& kernel) { return kernel(o_idx, d_idx); });
+}
+
+AircraftRoute::Compact AircraftRoute::Compact::create(
+    uint16_t o_idx,
+    uint16_t d_idx,
+    const Aircraft& ac,
+    const AircraftRoute::Options& options,
+    const User& user,
+    const PaxDemand& pax_demand
+) {
+    return with_route_kernel(ac, options, user, [&](const auto& kernel) { return kernel(o_idx, d_idx, pax_demand); });
 }
 
 AircraftRoute::Stopover::Stopover() : exists(false) {}
@@ -283,45 +691,71 @@ AircraftRoute::Stopover AircraftRoute::Stopover::find_by_efficiency(
     const Airport& origin, const Airport& destination, const Aircraft& aircraft, User::GameMode game_mode
 ) {
     const auto& db = Database::Client();
-    const auto& airports = db->airports;
-    const auto& distances = db->distances;
-    Airport candidate = Airport();
-    double candidate_distance = 99999;
+    uint16_t airport_idx;
+    double full_distance;
+    find_stopover(
+        db->airport_id_hashtable[origin.id], db->airport_id_hashtable[destination.id], aircraft, game_mode,
+        airport_idx, full_distance
+    );
+    if (airport_idx == AircraftRoute::Compact::NO_STOPOVER) return Stopover();
+    return Stopover(db->airports[airport_idx], full_distance);
+}
 
-    const double ac_range = static_cast<double>(aircraft.range);
-    const uint16_t o_idx = db->airport_id_hashtable[origin.id];
-    const uint16_t d_idx = db->airport_id_hashtable[destination.id];
-    // d_o & d_d will catch cases where idx == o_idx || idx == d_idx
-    if (game_mode == User::GameMode::EASY) {
-        for (uint16_t idx = 0; idx < AIRPORT_COUNT; idx++) {
-            const Airport& ap = airports[idx];
-            const double d_o = distances[o_idx][idx];
-            if (d_o > ac_range || d_o < 100.0) continue;
-            const double d_d = distances[d_idx][idx];
-            if (d_d > ac_range || d_d < 100.0) continue;
-            if (d_o + d_d < candidate_distance) {
-                candidate = ap;
-                candidate_distance = d_o + d_d;
-            }
-        }
-    } else {
-        const uint16_t rwy_requirement = aircraft.rwy;
-        for (uint16_t idx = 0; idx < AIRPORT_COUNT; idx++) {
-            const Airport& ap = airports[idx];
-            if (ap.rwy < rwy_requirement) continue;
-            const double d_o = distances[o_idx][idx];
-            if (d_o > ac_range || d_o < 100.0) continue;
-            const double d_d = distances[d_idx][idx];
-            if (d_d > ac_range || d_d < 100.0) continue;
-            if (d_o + d_d < candidate_distance) {
-                candidate = ap;
-                candidate_distance = d_o + d_d;
-            }
+StopoverCache::StopoverCache(size_t capacity) : entries(capacity) {}
+
+StopoverCache& StopoverCache::Default() {
+    static StopoverCache cache(1 << 18);  // 6 MB
+    return cache;
+}
+
+bool StopoverCache::lookup(uint64_t key, uint16_t& airport_idx, double& full_distance) {
+    std::shared_lock<std::shared_mutex> resize_lock(resize_mtx);
+    if (entries.empty()) return false;
+    const size_t slot = slot_of(key);
+    {
+        std::lock_guard<std::mutex> lock(stripe_mtx[slot % LOCK_STRIPES]);
+        const Entry& entry = entries[slot];
+        if (entry.key == key) {
+            airport_idx = entry.airport_idx;
+            full_distance = entry.full_distance;
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
         }
     }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void StopoverCache::insert(uint64_t key, uint16_t airport_idx, double full_distance) {
+    std::shared_lock<std::shared_mutex> resize_lock(resize_mtx);
+    if (entries.empty()) return;
+    const size_t slot = slot_of(key);
+    std::lock_guard<std::mutex> lock(stripe_mtx[slot % LOCK_STRIPES]);
+    Entry& entry = entries[slot];
+    if (entry.key == 0) size.fetch_add(1, std::memory_order_relaxed);
+    entry.key = key;
+    entry.airport_idx = airport_idx;
+    entry.full_distance = full_distance;
+}
 
-    if (!candidate.valid) return Stopover();
-    return Stopover(candidate, candidate_distance);
+void StopoverCache::set_capacity(size_t capacity) {
+    std::unique_lock<std::shared_mutex> resize_lock(resize_mtx);
+    entries = std::vector<Entry>(capacity);
+    entries.shrink_to_fit();
+    size = 0;
+}
+
+void StopoverCache::clear() {
+    std::unique_lock<std::shared_mutex> resize_lock(resize_mtx);
+    std::fill(entries.begin(), entries.end(), Entry());
+    size = 0;
+    hits = 0;
+    misses = 0;
+}
+
+StopoverCache::Stats StopoverCache::stats() const {
+    std::shared_lock<std::shared_mutex> resize_lock(resize_mtx);
+    return Stats{hits.load(), misses.load(), size.load(), entries.size()};
 }
 
 const string AircraftRoute::Stopover::repr(const Stopover& stopover) {
@@ -469,27 +903,716 @@ const string AircraftRoute::repr(const AircraftRoute& ar) {
 Destination::Destination(const Airport& destination, const AircraftRoute& route)
     : airport(destination), ac_route(route) {}
 
-std::vector<Destination> RoutesSearch::get() const {
+using SortBy = AircraftRoute::Options::SortBy;
+constexpr size_t SORT_BY_COUNT = static_cast<size_t>(SortBy::WEIGHTED);  // the scores WEIGHTED sums
+
+// what the scores read besides the route itself
+struct RouteScoreContext {
+    double inv_ac_cost;
+    double inv_amortisation_days;  // 0: the hub cost is ignored
+    const Airport* airports;
+};
+
+// the score of a route ranked by sort_by, the higher the better. o_idx is the origin of the route, for its hub cost.
+template <SortBy sort_by>
+struct RouteScore;
+template <>
+struct RouteScore<SortBy::PER_TRIP> {
+    static double of(const AircraftRoute::Compact& ar, uint16_t, const RouteScoreContext&) { return ar.profit; }
+};
+template <>
+struct RouteScore<SortBy::PER_AC_PER_DAY> {
+    static double of(const AircraftRoute::Compact& ar, uint16_t, const RouteScoreContext&) {
+        return ar.profit * ar.trips_per_day_per_ac;
+    }
+};
+template <>
+struct RouteScore<SortBy::PER_FLIGHT_HOUR> {
+    static double of(const AircraftRoute::Compact& ar, uint16_t, const RouteScoreContext&) {
+        return ar.profit / ar.flight_time;
+    }
+};
+template <>
+struct RouteScore<SortBy::PER_AC_COST> {
+    static double of(const AircraftRoute::Compact& ar, uint16_t, const RouteScoreContext& ctx) {
+        return ar.profit * ar.trips_per_day_per_ac * ctx.inv_ac_cost;
+    }
+};
+template <>
+struct RouteScore<SortBy::CONTRIBUTION_PER_AC_PER_DAY> {
+    static double of(const AircraftRoute::Compact& ar, uint16_t, const RouteScoreContext&) {
+        return static_cast<double>(ar.contribution) * ar.trips_per_day_per_ac;
+    }
+};
+template <>
+struct RouteScore<SortBy::NET_OF_HUB_COST> {
+    static double of(const AircraftRoute::Compact& ar, uint16_t o_idx, const RouteScoreContext& ctx) {
+        return ar.profit * ar.trips_per_day_per_ac - ctx.airports[o_idx].hub_cost * ctx.inv_amortisation_days;
+    }
+};
+
+// Scores routes by Options::sort_by, as a weighted sum of the RouteScores unrolled at compile time. A single SortBy
+// weighs 1 on its own score and 0 on the others, whose terms are skipped, so its score is kept bit for bit.
+class RouteScorer {
+   public:
+    RouteScorer(const Aircraft& ac, const AircraftRoute::Options& options)
+        : ctx{
+              1.0 / std::max(static_cast<double>(ac.cost), 1.0),
+              options.amortisation_days > 0 ? 1.0 / options.amortisation_days : 0.0,
+              Database::Client()->airports,
+          } {
+        if (options.sort_by != SortBy::WEIGHTED) {
+            weights[static_cast<size_t>(options.sort_by)] = 1.0;
+            return;
+        }
+        for (const auto& [sort_by, weight] : options.sort_weights) {
+            if (sort_by != SortBy::WEIGHTED) weights[static_cast<size_t>(sort_by)] += weight;
+        }
+    }
+
+    double operator()(const AircraftRoute::Compact& ar, uint16_t o_idx) const {
+        return sum(ar, o_idx, std::make_index_sequence<SORT_BY_COUNT>());
+    }
+
+   private:
+    std::array<double, SORT_BY_COUNT> weights{};
+    RouteScoreContext ctx;
+
+    template <size_t... I>
+    double sum(const AircraftRoute::Compact& ar, uint16_t o_idx, std::index_sequence<I...>) const {
+        return (0.0 + ... + term<static_cast<SortBy>(I)>(weights[I], ar, o_idx));
+    }
+    template <SortBy sort_by>
+    double term(double weight, const AircraftRoute::Compact& ar, uint16_t o_idx) const {
+        return weight == 0 ? 0.0 : weight * RouteScore<sort_by>::of(ar, o_idx, ctx);
+    }
+};
+
+// the scan only deals in compact routes and airport indices. Destinations (with their copies of the airports) or
+// columns are built at the very end, for the returned rows only.
+struct SearchCandidate {
+    double score;
+    uint16_t idx;
+    AircraftRoute::Compact ar;
+};
+
+// the routes from (or, with inbound, into) airports[ap_idx], ranked, for RoutesSearch and ReverseRoutesSearch. with
+// inbound, SearchCandidate::idx is the origin of the route.
+static std::vector<SearchCandidate> scan_airport(
+    uint16_t ap_idx,
+    bool inbound,
+    const Aircraft& aircraft,
+    const AircraftRoute::Options& options,
+    const User& user,
+    size_t top_k
+) {
+    const auto& db = Database::Client();
+    const auto pool = ThreadPool::Default();
+    using Candidate = SearchCandidate;
+
+    // destinations are ranked by score, ties going to the one scanned first (i.e. the lower airport id), so that the
+    // top k are always the first k of the full list. scores are taken once, as routes are evaluated.
+    const RouteScorer score(aircraft, options);
+    auto cmp = [&](const Candidate& a, const Candidate& b) {
+        return a.score > b.score || (a.score == b.score && db->airports[a.idx].id < db->airports[b.idx].id);
+    };
+
+    // each chunk of airports collects into its own buffer: concatenating them in chunk order reproduces the exact
+    // order of the serial scan. with top_k, each buffer is a heap holding the chunk's best k (worst on top).
+    const size_t num_chunks = ThreadPool::num_chunks(AIRPORT_COUNT, ROUTES_SEARCH_CHUNK_SIZE);
+    std::vector<std::vector<Candidate>> buffers(num_chunks);
+
+    const uint16_t rwy_requirement = user.game_mode == User::GameMode::EASY ? 0 : aircraft.rwy;
+    // inbound, only the runway of airports[ap_idx] matters: every route into it is rejected if it is too short
+    if (inbound && db->airports[ap_idx].rwy < rwy_requirement) return {};
+    // dispatched once: the whole scan runs inside the kernel specialised for this aircraft, game mode and tpd mode
+    with_route_kernel(aircraft, options, user, [&](const auto& kernel) {
+        pool->parallel_for(AIRPORT_COUNT, ROUTES_SEARCH_CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<Candidate>& buffer = buffers[chunk];
+            for (size_t i = begin; i < end; i++) {
+                const uint16_t idx = static_cast<uint16_t>(i);
+                if (idx == ap_idx || (!inbound && db->airports[idx].rwy < rwy_requirement)) continue;
+                const auto ar = inbound ? kernel(idx, ap_idx) : kernel(ap_idx, idx);
+                if (!ar.valid) continue;
+                const double s = score(ar, inbound ? idx : ap_idx);
+                if (top_k == 0) {
+                    buffer.push_back({s, idx, ar});
+                } else if (buffer.size() < top_k) {
+                    buffer.push_back({s, idx, ar});
+                    std::push_heap(buffer.begin(), buffer.end(), cmp);
+                } else if (s > buffer.front().score) {  // scanned later, so must be strictly better
+                    std::pop_heap(buffer.begin(), buffer.end(), cmp);
+                    buffer.back() = {s, idx, ar};
+                    std::push_heap(buffer.begin(), buffer.end(), cmp);
+                }
+            }
+        });
+    });
+
+    size_t total = 0;
+    for (const auto& buffer : buffers) total += buffer.size();
+    std::vector<Candidate> candidates;
+    candidates.reserve(total);
+    for (auto& buffer : buffers) {
+        std::move(buffer.begin(), buffer.end(), std::back_inserter(candidates));
+    }
+    if (top_k != 0 && top_k < candidates.size()) {
+        std::partial_sort(candidates.begin(), candidates.begin() + top_k, candidates.end(), cmp);
+        candidates.erase(candidates.begin() + top_k, candidates.end());
+    } else {
+        std::sort(candidates.begin(), candidates.end(), cmp);
+    }
+    return candidates;
+}
+
+// with inbound, Destination::airport is the origin of the route.
+static std::vector<Destination> search_airport(
+    uint16_t ap_idx,
+    bool inbound,
+    const Aircraft& aircraft,
+    const AircraftRoute::Options& options,
+    const User& user,
+    size_t top_k
+) {
+    const auto& db = Database::Client();
+    const auto candidates = scan_airport(ap_idx, inbound, aircraft, options, user, top_k);
     std::vector<Destination> destinations;
+    destinations.reserve(candidates.size());
+    for (const SearchCandidate& c : candidates) destinations.emplace_back(db->airports[c.idx], AircraftRoute(c.ar));
+    return destinations;
+}
+
+std::vector<Destination> RoutesSearch::get(size_t top_k) const {
+    const uint16_t o_idx = Database::Client()->airport_id_hashtable[this->origin.id];
+    return search_airport(o_idx, false, this->aircraft, this->options, this->user, top_k);
+}
+
+RouteColumns RoutesSearch::get_columns(size_t top_k) const {
+    const uint16_t o_idx = Database::Client()->airport_id_hashtable[this->origin.id];
+    const auto candidates = scan_airport(o_idx, false, this->aircraft, this->options, this->user, top_k);
+    RouteColumns columns;
+    columns.resize(candidates.size(), this->aircraft.type);
+    const auto pool = ThreadPool::Default();
+    pool->parallel_for(candidates.size(), ROUTES_SEARCH_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) columns.set(i, o_idx, candidates[i].idx, candidates[i].ar);
+    });
+    columns.fill_airports();
+    return columns;
+}
+
+RouteColumns RoutesSearch::get_columns(const vector<Destination>& destinations) const {
     const auto& db = Database::Client();
+    const uint16_t o_idx = db->airport_id_hashtable[this->origin.id];
+    RouteColumns columns;
+    columns.resize(destinations.size(), this->aircraft.type);
+    for (size_t i = 0; i < destinations.size(); i++) {
+        const Destination& d = destinations[i];
+        columns.set(i, o_idx, db->airport_id_hashtable[d.airport.id], d.ac_route);
+    }
+    columns.fill_airports();
+    return columns;
+}
+
+constexpr size_t PARETO_MAX_OBJECTIVES = 4;  // the members of RoutesSearch::Objective
+
+// The non-dominated routes seen so far, each with a point whose first num_objectives coordinates are all maximised.
+// Entries are kept sorted by the first coordinate, best first: only the entries at or ahead of a new point can
+// dominate it, and only those at or behind it can be dominated by it.
+class ParetoFront {
+   public:
+    using Point = std::array<double, PARETO_MAX_OBJECTIVES>;
+    struct Entry {
+        Point point;
+        uint16_t idx;
+        AircraftRoute::Compact ar;
+    };
+
+    vector<Entry> entries;
+
+    explicit ParetoFront(size_t num_objectives) : num_objectives(num_objectives) {}
+
+    // false if the point is dominated. a point equal to an entry is kept alongside it.
+    bool insert(const Point& p, uint16_t idx, const AircraftRoute::Compact& ar) {
+        auto ahead_end = std::upper_bound(entries.begin(), entries.end(), p[0], [](double x, const Entry& e) {
+            return x > e.point[0];
+        });
+        // the nearest entries ahead are the likeliest to dominate it
+        for (auto it = ahead_end; it != entries.begin();) {
+            --it;
+            if (dominates(it->point, p)) return false;
+        }
+        auto behind_begin = std::lower_bound(entries.begin(), ahead_end, p[0], [](const Entry& e, double x) {
+            return e.point[0] > x;
+        });
+        entries.erase(
+            std::remove_if(behind_begin, entries.end(), [&](const Entry& e) { return dominates(p, e.point); }),
+            entries.end()
+        );
+        ahead_end = std::upper_bound(entries.begin(), entries.end(), p[0], [](double x, const Entry& e) {
+            return x > e.point[0];
+        });
+        entries.insert(ahead_end, {p, idx, ar});
+        return true;
+    }
+
+   private:
+    size_t num_objectives;
+
+    bool dominates(const Point& a, const Point& b) const {
+        bool better = false;
+        for (size_t i = 0; i < num_objectives; i++) {
+            if (a[i] < b[i]) return false;
+            if (a[i] > b[i]) better = true;
+        }
+        return better;
+    }
+};
+
+std::vector<Destination> RoutesSearch::get_pareto_front(const vector<Objective>& objectives) const {
+    if (objectives.empty()) throw std::invalid_argument("get_pareto_front: at least one objective is required");
+    const auto& db = Database::Client();
+    const auto pool = ThreadPool::Default();
+    const uint16_t o_idx = db->airport_id_hashtable[this->origin.id];
+
+    vector<Objective> distinct;
+    for (const Objective objective : objectives) {
+        if (std::find(distinct.begin(), distinct.end(), objective) == distinct.end()) distinct.push_back(objective);
+    }
+    auto point = [&](const AircraftRoute::Compact& ar) {
+        ParetoFront::Point p{};
+        for (size_t i = 0; i < distinct.size(); i++) {
+            switch (distinct[i]) {
+                case Objective::PROFIT_PER_DAY:
+                    p[i] = ar.profit * ar.trips_per_day_per_ac;
+                    break;
+                case Objective::CONTRIBUTION_PER_DAY:
+                    p[i] = static_cast<double>(ar.contribution) * ar.trips_per_day_per_ac;
+                    break;
+                case Objective::FLIGHT_TIME:
+                    p[i] = -static_cast<double>(ar.flight_time);
+                    break;
+                case Objective::CO2:
+                    p[i] = -ar.co2;
+                    break;
+            }
+        }
+        return p;
+    };
 
+    // each chunk of airports keeps its own front, merged in chunk order once the scan is done
+    const size_t num_chunks = ThreadPool::num_chunks(AIRPORT_COUNT, ROUTES_SEARCH_CHUNK_SIZE);
+    std::vector<ParetoFront> fronts(num_chunks, ParetoFront(distinct.size()));
     const uint16_t rwy_requirement = this->user.game_mode == User::GameMode::EASY ? 0 : this->aircraft.rwy;
-    for (const Airport& ap : db->airports) {
-        if (ap.rwy < rwy_requirement || ap.id == this->origin.id) continue;
-        const AircraftRoute ar = AircraftRoute::create(this->origin, ap, this->aircraft, this->options, this->user);
-        if (!ar.valid) continue;
-        destinations.emplace_back(ap, ar);
-    }
-    auto cmp = this->options.sort_by == AircraftRoute::Options::SortBy::PER_TRIP
-                   ? [](const Destination& a, const Destination& b) { return a.ac_route.profit > b.ac_route.profit; }
-                   : [](const Destination& a, const Destination& b) {
-                         return a.ac_route.profit * a.ac_route.trips_per_day_per_ac >
-                                b.ac_route.profit * b.ac_route.trips_per_day_per_ac;
-                     };
-    std::sort(destinations.begin(), destinations.end(), cmp);
+    with_route_kernel(this->aircraft, this->options, this->user, [&](const auto& kernel) {
+        pool->parallel_for(AIRPORT_COUNT, ROUTES_SEARCH_CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const uint16_t d_idx = static_cast<uint16_t>(i);
+                if (d_idx == o_idx || db->airports[d_idx].rwy < rwy_requirement) continue;
+                const auto ar = kernel(o_idx, d_idx);
+                if (ar.valid) fronts[chunk].insert(point(ar), d_idx, ar);
+            }
+        });
+    });
+    ParetoFront front(distinct.size());
+    for (const ParetoFront& chunk_front : fronts) {
+        for (const auto& e : chunk_front.entries) front.insert(e.point, e.idx, e.ar);
+    }
+
+    std::sort(front.entries.begin(), front.entries.end(), [&](const auto& a, const auto& b) {
+        if (a.point[0] != b.point[0]) return a.point[0] > b.point[0];
+        return db->airports[a.idx].id < db->airports[b.idx].id;
+    });
+    std::vector<Destination> destinations;
+    destinations.reserve(front.entries.size());
+    for (const auto& e : front.entries) destinations.emplace_back(db->airports[e.idx], AircraftRoute(e.ar));
     return destinations;
 }
 
+std::vector<Destination> ReverseRoutesSearch::get(size_t top_k) const {
+    const uint16_t d_idx = Database::Client()->airport_id_hashtable[this->destination.id];
+    return search_airport(d_idx, true, this->aircraft, this->options, this->user, top_k);
+}
+
+void RouteColumns::StringColumn::push_back(const string& s) {
+    data.insert(data.end(), s.begin(), s.end());
+    offsets.push_back(static_cast<int32_t>(data.size()));
+}
+
+void RouteColumns::resize(size_t n, Aircraft::Type ac_type) {
+    for (auto* col : {&origin_id, &destination_id, &stopover_id, &trips_per_day_per_ac, &num_ac}) col->resize(n);
+    for (auto* col : {&direct_distance, &full_distance, &max_income, &income, &fuel, &co2, &acheck_cost, &repair_cost,
+                      &profit})
+        col->resize(n);
+    for (auto* col : {&flight_time, &contribution}) col->resize(n);
+    ci.resize(n);
+    if (ac_type == Aircraft::Type::CARGO) {
+        for (auto* col : {&demand_l, &demand_h}) col->resize(n);
+        for (auto* col : {&config_l, &config_h}) col->resize(n);
+        for (auto* col : {&ticket_l, &ticket_h}) col->resize(n);
+    } else {
+        for (auto* col : {&demand_y, &demand_j, &demand_f, &config_y, &config_j, &config_f, &ticket_y, &ticket_j,
+                          &ticket_f})
+            col->resize(n);
+    }
+}
+
+// the columns AircraftRoute and AircraftRoute::Compact share
+template <typename AR>
+static void set_route_columns(RouteColumns& c, size_t i, const AR& ar) {
+    c.direct_distance[i] = ar.route.direct_distance;
+    if (ar._ac_type == Aircraft::Type::CARGO) {
+        const CargoDemand dem(ar.route.pax_demand);
+        const auto& cfg = std::get<Aircraft::CargoConfig>(ar.config);
+        const auto& tkt = std::get<CargoTicket>(ar.ticket);
+        c.demand_l[i] = dem.l;
+        c.demand_h[i] = dem.h;
+        c.config_l[i] = cfg.l;
+        c.config_h[i] = cfg.h;
+        c.ticket_l[i] = tkt.l;
+        c.ticket_h[i] = tkt.h;
+    } else {
+        const auto& cfg = std::get<Aircraft::PaxConfig>(ar.config);
+        c.demand_y[i] = ar.route.pax_demand.y;
+        c.demand_j[i] = ar.route.pax_demand.j;
+        c.demand_f[i] = ar.route.pax_demand.f;
+        c.config_y[i] = cfg.y;
+        c.config_j[i] = cfg.j;
+        c.config_f[i] = cfg.f;
+        if (ar._ac_type == Aircraft::Type::VIP) {
+            const auto& tkt = std::get<VIPTicket>(ar.ticket);
+            c.ticket_y[i] = tkt.y;
+            c.ticket_j[i] = tkt.j;
+            c.ticket_f[i] = tkt.f;
+        } else {
+            const auto& tkt = std::get<PaxTicket>(ar.ticket);
+            c.ticket_y[i] = tkt.y;
+            c.ticket_j[i] = tkt.j;
+            c.ticket_f[i] = tkt.f;
+        }
+    }
+    c.flight_time[i] = ar.flight_time;
+    c.trips_per_day_per_ac[i] = ar.trips_per_day_per_ac;
+    c.num_ac[i] = ar.num_ac;
+    c.max_income[i] = ar.max_income;
+    c.income[i] = ar.income;
+    c.fuel[i] = ar.fuel;
+    c.co2[i] = ar.co2;
+    c.acheck_cost[i] = ar.acheck_cost;
+    c.repair_cost[i] = ar.repair_cost;
+    c.profit[i] = ar.profit;
+    c.ci[i] = ar.ci;
+    c.contribution[i] = ar.contribution;
+}
+
+void RouteColumns::set(size_t i, uint16_t o_idx, uint16_t d_idx, const AircraftRoute::Compact& ar) {
+    const auto& db = Database::Client();
+    origin_id[i] = db->airports[o_idx].id;
+    destination_id[i] = db->airports[d_idx].id;
+    stopover_id[i] = ar.needs_stopover ? db->airports[ar.stopover_idx].id : 0;
+    full_distance[i] = ar.needs_stopover ? ar.stopover_full_distance : ar.route.direct_distance;
+    set_route_columns(*this, i, ar);
+}
+
+void RouteColumns::set(size_t i, uint16_t o_idx, uint16_t d_idx, const AircraftRoute& ar) {
+    const auto& db = Database::Client();
+    origin_id[i] = db->airports[o_idx].id;
+    destination_id[i] = db->airports[d_idx].id;
+    stopover_id[i] = ar.needs_stopover ? ar.stopover.airport.id : 0;
+    full_distance[i] = ar.needs_stopover ? ar.stopover.full_distance : ar.route.direct_distance;
+    set_route_columns(*this, i, ar);
+}
+
+void RouteColumns::fill_airports() {
+    const auto& db = Database::Client();
+    const size_t n = size();
+    for (auto* col : {&origin_lat, &origin_lng, &destination_lat, &destination_lng}) col->resize(n);
+    auto add = [&](const Airport& ap, StringColumn& name, StringColumn& country, StringColumn& iata,
+                   StringColumn& icao) {
+        name.push_back(ap.name);
+        country.push_back(ap.country);
+        iata.push_back(ap.iata);
+        icao.push_back(ap.icao);
+    };
+    const Airport none;
+    for (size_t i = 0; i < n; i++) {
+        const Airport& o = db->airports[db->airport_id_hashtable[origin_id[i]]];
+        const Airport& d = db->airports[db->airport_id_hashtable[destination_id[i]]];
+        const Airport& s = stopover_id[i] == 0 ? none : db->airports[db->airport_id_hashtable[stopover_id[i]]];
+        origin_lat[i] = o.lat;
+        origin_lng[i] = o.lng;
+        destination_lat[i] = d.lat;
+        destination_lng[i] = d.lng;
+        add(o, origin_name, origin_country, origin_iata, origin_icao);
+        add(d, destination_name, destination_country, destination_iata, destination_icao);
+        add(s, stopover_name, stopover_country, stopover_iata, stopover_icao);
+    }
+}
+
+GlobalRoutesSearch::Result GlobalRoutesSearch::get(size_t top_k, bool both_directions) const {
+    const auto& db = Database::Client();
+    const auto pool = ThreadPool::Default();
+
+    struct Candidate {
+        double score;
+        uint16_t o_idx;
+        uint16_t d_idx;
+    };
+    const RouteScorer score(this->aircraft, this->options);
+    // airports are stored in id order, so comparing indices compares ids
+    auto cmp = [](const Candidate& a, const Candidate& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.o_idx < b.o_idx || (a.o_idx == b.o_idx && a.d_idx < b.d_idx);
+    };
+
+    // chunk c holds the pairs (a, b), a < b, for the origins a of that chunk. with top_k, each buffer is a heap holding
+    // the chunk's best k (worst on top).
+    const size_t num_chunks = ThreadPool::num_chunks(AIRPORT_COUNT, GLOBAL_ROUTES_SEARCH_CHUNK_SIZE);
+    std::vector<std::vector<Candidate>> buffers(num_chunks);
+    const uint16_t rwy_requirement = this->user.game_mode == User::GameMode::EASY ? 0 : this->aircraft.rwy;
+    with_route_kernel(this->aircraft, this->options, this->user, [&](const auto& kernel) {
+        pool->parallel_for(AIRPORT_COUNT, GLOBAL_ROUTES_SEARCH_CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<Candidate>& buffer = buffers[chunk];
+            auto offer = [&](const Candidate& c) {
+                if (top_k == 0) {
+                    buffer.push_back(c);
+                } else if (buffer.size() < top_k) {
+                    buffer.push_back(c);
+                    std::push_heap(buffer.begin(), buffer.end(), cmp);
+                } else if (cmp(c, buffer.front())) {
+                    std::pop_heap(buffer.begin(), buffer.end(), cmp);
+                    buffer.back() = c;
+                    std::push_heap(buffer.begin(), buffer.end(), cmp);
+                }
+            };
+            for (size_t i = begin; i < end; i++) {
+                const uint16_t a = static_cast<uint16_t>(i);
+                const bool a_ok = db->airports[a].rwy >= rwy_requirement;
+                for (uint16_t b = static_cast<uint16_t>(a + 1); b < AIRPORT_COUNT; b++) {
+                    const bool b_ok = db->airports[b].rwy >= rwy_requirement;
+                    if (!a_ok && !b_ok) continue;
+                    const auto ar = b_ok ? kernel(a, b) : kernel(b, a);
+                    if (!ar.valid) continue;
+                    if (b_ok) offer({score(ar, a), a, b});
+                    if (a_ok && (both_directions || !b_ok)) offer({score(ar, b), b, a});
+                }
+            }
+        });
+    });
+
+    size_t total = 0;
+    for (const auto& buffer : buffers) total += buffer.size();
+    std::vector<Candidate> candidates;
+    candidates.reserve(total);
+    for (auto& buffer : buffers) {
+        std::move(buffer.begin(), buffer.end(), std::back_inserter(candidates));
+        std::vector<Candidate>().swap(buffer);
+    }
+    if (top_k != 0 && top_k < candidates.size()) {
+        std::partial_sort(candidates.begin(), candidates.begin() + top_k, candidates.end(), cmp);
+        candidates.erase(candidates.begin() + top_k, candidates.end());
+    } else {
+        std::sort(candidates.begin(), candidates.end(), cmp);
+    }
+
+    Result result;
+    result.resize(candidates.size(), this->aircraft.type);
+    with_route_kernel(this->aircraft, this->options, this->user, [&](const auto& kernel) {
+        pool->parallel_for(candidates.size(), ROUTES_SEARCH_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const Candidate& c = candidates[i];
+                result.set(i, c.o_idx, c.d_idx, kernel(c.o_idx, c.d_idx));
+            }
+        });
+    });
+    result.fill_airports();
+    return result;
+}
+
+// everything route evaluation reads from the aircraft, options and user (see RouteKernel and the calc_* functions):
+// two HubSearches with equal profiles evaluate every route the same.
+struct HubProfile {
+    Aircraft::Type type;
+    float speed, fuel, co2;
+    uint32_t cost, capacity, check_cost;
+    uint16_t rwy, range, maint;
+    bool fuel_mod;
+    AircraftRoute::Options::TPDMode tpd_mode;
+    uint16_t trips_per_day_per_ac;
+    double max_distance;
+    float max_flight_time;
+    AircraftRoute::Options::ConfigAlgorithm config_algorithm;
+    AircraftRoute::Options::CIMode ci_mode;
+    User::GameMode game_mode;
+    uint8_t repair_training, l_training, h_training, fuel_training, co2_training;
+    uint16_t fuel_price;
+    uint8_t co2_price;
+    double load, income_loss_tol;
+
+    HubProfile(const Aircraft& ac, const AircraftRoute::Options& options, const User& user)
+        : type(ac.type),
+          speed(ac.speed),
+          fuel(ac.fuel),
+          co2(ac.co2),
+          cost(ac.cost),
+          capacity(ac.capacity),
+          check_cost(ac.check_cost),
+          rwy(ac.rwy),
+          range(ac.range),
+          maint(ac.maint),
+          fuel_mod(ac.fuel_mod),
+          tpd_mode(options.tpd_mode),
+          trips_per_day_per_ac(options.trips_per_day_per_ac),
+          max_distance(options.max_distance),
+          max_flight_time(options.max_flight_time),
+          config_algorithm(options.config_algorithm),
+          ci_mode(options.ci_mode),
+          game_mode(user.game_mode),
+          repair_training(user.repair_training),
+          l_training(user.l_training),
+          h_training(user.h_training),
+          fuel_training(user.fuel_training),
+          co2_training(user.co2_training),
+          fuel_price(user.fuel_price),
+          co2_price(user.co2_price),
+          load(user.load),
+          income_loss_tol(user.income_loss_tol) {}
+
+    auto fields() const {
+        return std::tie(
+            type, speed, fuel, co2, cost, capacity, check_cost, rwy, range, maint, fuel_mod, tpd_mode,
+            trips_per_day_per_ac, max_distance, max_flight_time, config_algorithm, ci_mode, game_mode,
+            repair_training, l_training, h_training, fuel_training, co2_training, fuel_price, co2_price, load,
+            income_loss_tol
+        );
+    }
+    bool operator==(const HubProfile& other) const { return fields() == other.fields(); }
+};
+
+// [airport idx]: the daily profits of its best HUB_SEARCH_MAX_ROUTES routes as the origin, best first
+using HubRoutes = std::vector<std::vector<double>>;
+
+// the most recently used profile first
+struct HubCache {
+    std::mutex mtx;
+    std::deque<std::pair<HubProfile, shared_ptr<const HubRoutes>>> entries;
+};
+
+static HubCache& hub_cache() {
+    static HubCache cache;
+    return cache;
+}
+
+void HubSearch::clear_cache() {
+    HubCache& cache = hub_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    cache.entries.clear();
+}
+
+static shared_ptr<const HubRoutes> scan_hub_routes(
+    const Aircraft& aircraft, const AircraftRoute::Options& options, const User& user
+) {
+    const auto& db = Database::Client();
+    const auto pool = ThreadPool::Default();
+    const uint16_t rwy_requirement = user.game_mode == User::GameMode::EASY ? 0 : aircraft.rwy;
+
+    // 1. the daily profit of every pair, NaN if neither direction is valid. a route evaluates the same both ways, so
+    // each pair is evaluated once, towards an airport with a long enough runway.
+    std::vector<double> pair_profit(ROUTE_COUNT, std::numeric_limits<double>::quiet_NaN());
+    with_route_kernel(aircraft, options, user, [&](const auto& kernel) {
+        pool->parallel_for(AIRPORT_COUNT, GLOBAL_ROUTES_SEARCH_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const uint16_t a = static_cast<uint16_t>(i);
+                const bool a_ok = db->airports[a].rwy >= rwy_requirement;
+                for (uint16_t b = static_cast<uint16_t>(a + 1); b < AIRPORT_COUNT; b++) {
+                    const bool b_ok = db->airports[b].rwy >= rwy_requirement;
+                    if (!a_ok && !b_ok) continue;
+                    const auto ar = b_ok ? kernel(a, b) : kernel(b, a);
+                    if (ar.valid) pair_profit[Database::get_dbroute_idx(a, b)] = ar.profit * ar.trips_per_day_per_ac;
+                }
+            }
+        });
+    });
+
+    // 2. the best routes of every origin, among the destinations with a long enough runway
+    auto routes = std::make_shared<HubRoutes>(AIRPORT_COUNT);
+    pool->parallel_for(AIRPORT_COUNT, ROUTES_SEARCH_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+        std::vector<double> row;
+        for (size_t i = begin; i < end; i++) {
+            const uint16_t o = static_cast<uint16_t>(i);
+            row.clear();
+            for (uint16_t d = 0; d < AIRPORT_COUNT; d++) {
+                if (d == o || db->airports[d].rwy < rwy_requirement) continue;
+                const double profit = pair_profit[Database::get_dbroute_idx(o, d)];
+                if (!std::isnan(profit)) row.push_back(profit);
+            }
+            const size_t n = std::min(row.size(), HUB_SEARCH_MAX_ROUTES);
+            std::partial_sort(row.begin(), row.begin() + n, row.end(), std::greater<double>());
+            (*routes)[o].assign(row.begin(), row.begin() + n);
+        }
+    });
+    return routes;
+}
+
+std::vector<HubSearch::Hub> HubSearch::get(size_t top_n, double amortisation_days, size_t top_k) const {
+    const auto& db = Database::Client();
+    const HubProfile profile(this->aircraft, this->options, this->user);
+
+    shared_ptr<const HubRoutes> routes;
+    HubCache& cache = hub_cache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mtx);
+        for (auto it = cache.entries.begin(); it != cache.entries.end(); ++it) {
+            if (it->first == profile) {
+                routes = it->second;
+                cache.entries.erase(it);
+                cache.entries.emplace_front(profile, routes);
+                break;
+            }
+        }
+    }
+    if (!routes) {
+        // scanned without the lock: a concurrent search of the same profile may scan it too, and the last one wins
+        routes = scan_hub_routes(this->aircraft, this->options, this->user);
+        std::lock_guard<std::mutex> lock(cache.mtx);
+        cache.entries.emplace_front(profile, routes);
+        if (cache.entries.size() > HUB_SEARCH_CACHE_SIZE) cache.entries.pop_back();
+    }
+
+    struct Candidate {
+        uint16_t idx;
+        double score;
+        double routes_profit;
+        uint16_t num_routes;
+    };
+    std::vector<Candidate> candidates;
+    top_n = std::min(top_n, HUB_SEARCH_MAX_ROUTES);
+    for (uint16_t idx = 0; idx < AIRPORT_COUNT; idx++) {
+        const std::vector<double>& profits = (*routes)[idx];
+        if (profits.empty()) continue;
+        const size_t n = std::min(top_n, profits.size());
+        double routes_profit = 0;
+        for (size_t i = 0; i < n; i++) routes_profit += profits[i];
+        const double hub_cost = amortisation_days > 0 ? db->airports[idx].hub_cost / amortisation_days : 0;
+        candidates.push_back({idx, routes_profit - hub_cost, routes_profit, static_cast<uint16_t>(n)});
+    }
+
+    auto cmp = [](const Candidate& a, const Candidate& b) {
+        return a.score > b.score || (a.score == b.score && a.idx < b.idx);
+    };
+    if (top_k != 0 && top_k < candidates.size()) {
+        std::partial_sort(candidates.begin(), candidates.begin() + top_k, candidates.end(), cmp);
+        candidates.erase(candidates.begin() + top_k, candidates.end());
+    } else {
+        std::sort(candidates.begin(), candidates.end(), cmp);
+    }
+
+    std::vector<Hub> hubs;
+    hubs.reserve(candidates.size());
+    for (const Candidate& c : candidates)
+        hubs.push_back({db->airports[c.idx], c.score, c.routes_profit, c.num_routes});
+    return hubs;
+}
+
 #if BUILD_PYBIND == 1
 #include "include/binder.hpp"
 
@@ -577,73 +1700,28 @@ py::dict to_dict(const Destination& d) {
     return py::dict("airport"_a = to_dict(d.airport), "ac_route"_a = to_dict(d.ac_route));
 }
 
-std::map<string, py::list> _get_columns(const RoutesSearch& rs, const vector<Destination>& dests) {
-    // for use in csv generation via pyarrow.Table.from_pydict & downstream statistical analysis
-    // assuming dests to be all valid
-    std::map<string, py::list> cols;
-    for (const Destination& dest : dests) {
-        cols["00|dest.id"].append(dest.airport.id);
-        cols["01|dest.name"].append(dest.airport.name);
-        cols["02|dest.country"].append(dest.airport.country);
-        cols["03|dest.iata"].append(dest.airport.iata);
-        cols["04|dest.icao"].append(dest.airport.icao);
-        cols["98|dest.lat"].append(dest.airport.lat);
-        cols["99|dest.lng"].append(dest.airport.lng);
-        auto& acr = dest.ac_route;
-        if (dest.ac_route.stopover.exists) {
-            cols["05|stop.id"].append(acr.stopover.airport.id);
-            cols["06|stop.name"].append(acr.stopover.airport.name);
-            cols["07|stop.country"].append(acr.stopover.airport.country);
-            cols["08|stop.iata"].append(acr.stopover.airport.iata);
-            cols["09|stop.icao"].append(acr.stopover.airport.icao);
-            cols["10|full_dist"].append(acr.stopover.full_distance);
-        } else {
-            cols["05|stop.id"].append(py::none());
-            cols["06|stop.name"].append(py::none());
-            cols["07|stop.country"].append(py::none());
-            cols["08|stop.iata"].append(py::none());
-            cols["09|stop.icao"].append(py::none());
-            cols["10|full_dist"].append(py::none());
-        }
-        if (rs.aircraft.type == Aircraft::Type::CARGO) {
-            auto dem = CargoDemand(acr.route.pax_demand);
-            auto& cfg = get<Aircraft::CargoConfig>(acr.config);
-            auto& tkt = get<CargoTicket>(acr.ticket);
-            cols["11|dem.l"].append(dem.l);
-            cols["12|dem.h"].append(dem.h);
-            cols["14|cfg.l"].append(cfg.l);
-            cols["15|cfg.h"].append(cfg.h);
-            cols["17|tkt.l"].append(tkt.l);
-            cols["18|tkt.h"].append(tkt.h);
-        } else {
-            auto& dem = acr.route.pax_demand;
-            auto& cfg = get<Aircraft::PaxConfig>(acr.config);
-            auto& tkt =
-                rs.aircraft.type == Aircraft::Type::VIP ? get<VIPTicket>(acr.ticket) : get<PaxTicket>(acr.ticket);
-            cols["11|dem.y"].append(dem.y);
-            cols["12|dem.j"].append(dem.j);
-            cols["13|dem.f"].append(dem.f);
-            cols["14|cfg.y"].append(cfg.y);
-            cols["15|cfg.j"].append(cfg.j);
-            cols["16|cfg.f"].append(cfg.f);
-            cols["17|tkt.y"].append(tkt.y);
-            cols["18|tkt.j"].append(tkt.j);
-            cols["19|tkt.f"].append(tkt.f);
-        }
-        cols["20|direct_dist"].append(acr.route.direct_distance);
-        cols["21|time"].append(acr.flight_time);
-        cols["22|trips_pd_pa"].append(acr.trips_per_day_per_ac);
-        cols["23|num_ac"].append(acr.num_ac);
-        cols["24|income"].append(acr.income);
-        cols["25|fuel"].append(acr.fuel);
-        cols["26|co2"].append(acr.co2);
-        cols["27|chk_cost"].append(acr.acheck_cost);
-        cols["28|repair_cost"].append(acr.repair_cost);
-        cols["29|profit_pt"].append(acr.profit);
-        cols["30|ci"].append(acr.ci);
-        cols["31|contrib_pt"].append(acr.contribution);
-    }
-    return cols;
+// a column of RouteColumns, exported through the buffer protocol without a copy. a memoryview of it keeps it, and so
+// the object owning the column, alive.
+struct ColumnView {
+    py::object owner;
+    const void* ptr;
+    py::ssize_t size;
+    py::ssize_t itemsize;
+    string format;
+};
+
+template <typename T>
+static py::memoryview column_view(const py::object& owner, const vector<T>& col, const string& format) {
+    return py::memoryview(py::cast(
+        ColumnView{owner, col.data(), static_cast<py::ssize_t>(col.size()), static_cast<py::ssize_t>(sizeof(T)), format}
+    ));
+}
+
+template <typename T>
+static void def_column(py::class_<RouteColumns>& cls, const char* name, vector<T> RouteColumns::*col) {
+    cls.def_property_readonly(name, [col](const py::object& self) {
+        return column_view(self, self.cast<const RouteColumns&>().*col, py::format_descriptor<T>::format());
+    });
 }
 
 void pybind_init_route(py::module_& m) {
@@ -675,22 +1753,38 @@ void pybind_init_route(py::module_& m) {
         .value("STRICT", AircraftRoute::Options::TPDMode::STRICT);
     py::enum_<AircraftRoute::Options::SortBy>(acr_options_class, "SortBy")
         .value("PER_TRIP", AircraftRoute::Options::SortBy::PER_TRIP)
-        .value("PER_AC_PER_DAY", AircraftRoute::Options::SortBy::PER_AC_PER_DAY);
+        .value("PER_AC_PER_DAY", AircraftRoute::Options::SortBy::PER_AC_PER_DAY)
+        .value("PER_FLIGHT_HOUR", AircraftRoute::Options::SortBy::PER_FLIGHT_HOUR)
+        .value("PER_AC_COST", AircraftRoute::Options::SortBy::PER_AC_COST)
+        .value("CONTRIBUTION_PER_AC_PER_DAY", AircraftRoute::Options::SortBy::CONTRIBUTION_PER_AC_PER_DAY)
+        .value("NET_OF_HUB_COST", AircraftRoute::Options::SortBy::NET_OF_HUB_COST)
+        .value("WEIGHTED", AircraftRoute::Options::SortBy::WEIGHTED);
+    py::enum_<AircraftRoute::Options::CIMode>(acr_options_class, "CIMode")
+        .value("MAX", AircraftRoute::Options::CIMode::MAX)
+        .value("PROFIT", AircraftRoute::Options::CIMode::PROFIT)
+        .value("CONTRIBUTION", AircraftRoute::Options::CIMode::CONTRIBUTION);
     acr_options_class
         .def(
             py::init<
                 AircraftRoute::Options::TPDMode, uint16_t, double, double, AircraftRoute::Options::ConfigAlgorithm,
-                AircraftRoute::Options::SortBy>(),
+                AircraftRoute::Options::SortBy, AircraftRoute::Options::CIMode,
+                const vector<std::pair<AircraftRoute::Options::SortBy, double>>&, double>(),
             py::arg_v("tpd_mode", AircraftRoute::Options::TPDMode::AUTO, "TPDMode.AUTO"), "trips_per_day_per_ac"_a = 1,
             "max_distance"_a = MAX_DISTANCE, "max_flight_time"_a = 24.0f, "config_algorithm"_a = std::monostate(),
-            py::arg_v("sort_by", AircraftRoute::Options::SortBy::PER_TRIP, "SortBy.PER_TRIP")
+            py::arg_v("sort_by", AircraftRoute::Options::SortBy::PER_TRIP, "SortBy.PER_TRIP"),
+            py::arg_v("ci_mode", AircraftRoute::Options::CIMode::MAX, "CIMode.MAX"),
+            "sort_weights"_a = vector<std::pair<AircraftRoute::Options::SortBy, double>>(),
+            "amortisation_days"_a = 365.0
         )
         .def_readwrite("tpd_mode", &AircraftRoute::Options::tpd_mode)
         .def_readwrite("trips_per_day_per_ac", &AircraftRoute::Options::trips_per_day_per_ac)
         .def_readwrite("max_distance", &AircraftRoute::Options::max_distance)
         .def_readwrite("max_flight_time", &AircraftRoute::Options::max_flight_time)
         .def_readwrite("config_algorithm", &AircraftRoute::Options::config_algorithm)
-        .def_readwrite("sort_by", &AircraftRoute::Options::sort_by);
+        .def_readwrite("sort_by", &AircraftRoute::Options::sort_by)
+        .def_readwrite("ci_mode", &AircraftRoute::Options::ci_mode)
+        .def_readwrite("sort_weights", &AircraftRoute::Options::sort_weights)
+        .def_readwrite("amortisation_days", &AircraftRoute::Options::amortisation_days);
 
     py::class_<AircraftRoute::Stopover>(acr_class, "Stopover")
         .def_readonly("airport", &AircraftRoute::Stopover::airport)
@@ -700,6 +1794,21 @@ void pybind_init_route(py::module_& m) {
             "find_by_efficiency", &AircraftRoute::Stopover::find_by_efficiency, "origin"_a, "destination"_a,
             "aircraft"_a, "game_mode"_a
         )
+        .def_static(
+            "cache_stats",
+            []() {
+                const auto stats = StopoverCache::Default().stats();
+                return py::dict(
+                    "hits"_a = stats.hits, "misses"_a = stats.misses, "size"_a = stats.size,
+                    "capacity"_a = stats.capacity
+                );
+            }
+        )
+        .def_static("cache_clear", []() { StopoverCache::Default().clear(); })
+        .def_static(
+            "set_cache_capacity", [](size_t capacity) { StopoverCache::Default().set_capacity(capacity); },
+            "capacity"_a
+        )
         .def("__repr__", &AircraftRoute::Stopover::repr)
         .def("to_dict", py::overload_cast<const AircraftRoute::Stopover&>(&to_dict));
 
@@ -771,13 +1880,158 @@ void pybind_init_route(py::module_& m) {
         .def_readonly("ac_route", &Destination::ac_route)
         .def("to_dict", py::overload_cast<const Destination&>(&to_dict));
 
-    py::class_<RoutesSearch>(m_route, "RoutesSearch")
+    py::class_<ColumnView>(m_route, "_ColumnView", py::buffer_protocol()).def_buffer([](const ColumnView& v) {
+        return py::buffer_info(const_cast<void*>(v.ptr), v.itemsize, v.format, 1, {v.size}, {v.itemsize}, true);
+    });
+    py::class_<RouteColumns> columns_class(m_route, "RouteColumns");
+    using StringColumn = RouteColumns::StringColumn;
+    py::class_<StringColumn>(columns_class, "StringColumn")
+        .def_property_readonly(
+            "offsets",
+            [](const py::object& self) {
+                const auto& offsets = self.cast<const StringColumn&>().offsets;
+                return column_view(self, offsets, py::format_descriptor<int32_t>::format());
+            }
+        )
+        .def_property_readonly(
+            "data", [](const py::object& self) { return column_view(self, self.cast<const StringColumn&>().data, "B"); }
+        )
+        .def("__len__", &StringColumn::size)
+        .def("tolist", [](const StringColumn& c) {
+            py::list strings;
+            for (size_t i = 0; i < c.size(); i++)
+                strings.append(py::str(string(c.data.begin() + c.offsets[i], c.data.begin() + c.offsets[i + 1])));
+            return strings;
+        });
+    for (const auto& [name, col] : std::initializer_list<std::pair<const char*, vector<uint16_t> RouteColumns::*>>{
+             {"origin_id", &RouteColumns::origin_id},
+             {"destination_id", &RouteColumns::destination_id},
+             {"stopover_id", &RouteColumns::stopover_id},
+             {"demand_y", &RouteColumns::demand_y},
+             {"demand_j", &RouteColumns::demand_j},
+             {"demand_f", &RouteColumns::demand_f},
+             {"config_y", &RouteColumns::config_y},
+             {"config_j", &RouteColumns::config_j},
+             {"config_f", &RouteColumns::config_f},
+             {"ticket_y", &RouteColumns::ticket_y},
+             {"ticket_j", &RouteColumns::ticket_j},
+             {"ticket_f", &RouteColumns::ticket_f},
+             {"trips_per_day_per_ac", &RouteColumns::trips_per_day_per_ac},
+             {"num_ac", &RouteColumns::num_ac},
+         })
+        def_column(columns_class, name, col);
+    for (const auto& [name, col] : std::initializer_list<std::pair<const char*, vector<double> RouteColumns::*>>{
+             {"direct_distance", &RouteColumns::direct_distance},
+             {"full_distance", &RouteColumns::full_distance},
+             {"max_income", &RouteColumns::max_income},
+             {"income", &RouteColumns::income},
+             {"fuel", &RouteColumns::fuel},
+             {"co2", &RouteColumns::co2},
+             {"acheck_cost", &RouteColumns::acheck_cost},
+             {"repair_cost", &RouteColumns::repair_cost},
+             {"profit", &RouteColumns::profit},
+             {"origin_lat", &RouteColumns::origin_lat},
+             {"origin_lng", &RouteColumns::origin_lng},
+             {"destination_lat", &RouteColumns::destination_lat},
+             {"destination_lng", &RouteColumns::destination_lng},
+         })
+        def_column(columns_class, name, col);
+    for (const auto& [name, col] : std::initializer_list<std::pair<const char*, vector<float> RouteColumns::*>>{
+             {"ticket_l", &RouteColumns::ticket_l},
+             {"ticket_h", &RouteColumns::ticket_h},
+             {"flight_time", &RouteColumns::flight_time},
+             {"contribution", &RouteColumns::contribution},
+         })
+        def_column(columns_class, name, col);
+    def_column(columns_class, "demand_l", &RouteColumns::demand_l);
+    def_column(columns_class, "demand_h", &RouteColumns::demand_h);
+    def_column(columns_class, "config_l", &RouteColumns::config_l);
+    def_column(columns_class, "config_h", &RouteColumns::config_h);
+    def_column(columns_class, "ci", &RouteColumns::ci);
+    columns_class.def("__len__", &RouteColumns::size)
+        .def_readonly("origin_name", &RouteColumns::origin_name)
+        .def_readonly("origin_country", &RouteColumns::origin_country)
+        .def_readonly("origin_iata", &RouteColumns::origin_iata)
+        .def_readonly("origin_icao", &RouteColumns::origin_icao)
+        .def_readonly("destination_name", &RouteColumns::destination_name)
+        .def_readonly("destination_country", &RouteColumns::destination_country)
+        .def_readonly("destination_iata", &RouteColumns::destination_iata)
+        .def_readonly("destination_icao", &RouteColumns::destination_icao)
+        .def_readonly("stopover_name", &RouteColumns::stopover_name)
+        .def_readonly("stopover_country", &RouteColumns::stopover_country)
+        .def_readonly("stopover_iata", &RouteColumns::stopover_iata)
+        .def_readonly("stopover_icao", &RouteColumns::stopover_icao);
+
+    py::class_<RoutesSearch> routes_search_class(m_route, "RoutesSearch");
+    py::enum_<RoutesSearch::Objective>(routes_search_class, "Objective")
+        .value("PROFIT_PER_DAY", RoutesSearch::Objective::PROFIT_PER_DAY)
+        .value("CONTRIBUTION_PER_DAY", RoutesSearch::Objective::CONTRIBUTION_PER_DAY)
+        .value("FLIGHT_TIME", RoutesSearch::Objective::FLIGHT_TIME)
+        .value("CO2", RoutesSearch::Objective::CO2);
+    routes_search_class
         .def(
             py::init<const Airport&, const Aircraft&, const AircraftRoute::Options&, const User&>(), "ap0"_a, "ac"_a,
             py::arg_v("options", AircraftRoute::Options(), "AircraftRoute.Options()"),
             py::arg_v("user", User::Default(), "am4.utils.game.User.Default()")
         )
-        .def("get", &RoutesSearch::get, py::call_guard<py::gil_scoped_release>())
-        .def("_get_columns", py::overload_cast<const RoutesSearch&, const vector<Destination>&>(&_get_columns));
+        .def("get", &RoutesSearch::get, "top_k"_a = 0, py::call_guard<py::gil_scoped_release>())
+        .def(
+            "get_pareto_front", &RoutesSearch::get_pareto_front,
+            py::arg_v(
+                "objectives",
+                vector<RoutesSearch::Objective>{
+                    RoutesSearch::Objective::PROFIT_PER_DAY, RoutesSearch::Objective::CONTRIBUTION_PER_DAY
+                },
+                "[Objective.PROFIT_PER_DAY, Objective.CONTRIBUTION_PER_DAY]"
+            ),
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "get_columns", py::overload_cast<size_t>(&RoutesSearch::get_columns, py::const_), "top_k"_a = 0,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "get_columns", py::overload_cast<const vector<Destination>&>(&RoutesSearch::get_columns, py::const_),
+            "destinations"_a, py::call_guard<py::gil_scoped_release>()
+        );
+
+    py::class_<ReverseRoutesSearch>(m_route, "ReverseRoutesSearch")
+        .def(
+            py::init<const Airport&, const Aircraft&, const AircraftRoute::Options&, const User&>(), "ap1"_a, "ac"_a,
+            py::arg_v("options", AircraftRoute::Options(), "AircraftRoute.Options()"),
+            py::arg_v("user", User::Default(), "am4.utils.game.User.Default()")
+        )
+        .def("get", &ReverseRoutesSearch::get, "top_k"_a = 0, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<GlobalRoutesSearch> grs_class(m_route, "GlobalRoutesSearch");
+    grs_class.attr("Result") = columns_class;
+    grs_class
+        .def(
+            py::init<const Aircraft&, const AircraftRoute::Options&, const User&>(), "ac"_a,
+            py::arg_v("options", AircraftRoute::Options(), "AircraftRoute.Options()"),
+            py::arg_v("user", User::Default(), "am4.utils.game.User.Default()")
+        )
+        .def(
+            "get", &GlobalRoutesSearch::get, "top_k"_a = 1000, "both_directions"_a = true,
+            py::call_guard<py::gil_scoped_release>()
+        );
+
+    py::class_<HubSearch> hs_class(m_route, "HubSearch");
+    py::class_<HubSearch::Hub>(hs_class, "Hub")
+        .def_readonly("airport", &HubSearch::Hub::airport)
+        .def_readonly("score", &HubSearch::Hub::score)
+        .def_readonly("routes_profit", &HubSearch::Hub::routes_profit)
+        .def_readonly("num_routes", &HubSearch::Hub::num_routes);
+    hs_class
+        .def(
+            py::init<const Aircraft&, const AircraftRoute::Options&, const User&>(), "ac"_a,
+            py::arg_v("options", AircraftRoute::Options(), "AircraftRoute.Options()"),
+            py::arg_v("user", User::Default(), "am4.utils.game.User.Default()")
+        )
+        .def(
+            "get", &HubSearch::get, "top_n"_a = 10, "amortisation_days"_a = 365.0, "top_k"_a = 0,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def_static("clear_cache", &HubSearch::clear_cache);
 }
 #endif
\ No newline at end of file
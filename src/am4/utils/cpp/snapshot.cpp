@@ -0,0 +1,534 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "include/db.hpp"
+#include "include/snapshot.hpp"
+
+static_assert(std::is_trivially_copyable<PaxDemand>::value, "PaxDemand is mapped in place");
+static_assert(sizeof(PaxDemand) == 6, "PaxDemand is mapped in place");
+
+#ifdef _WIN32
+// no mmap: read the whole file instead, which still skips all the parsing
+MappedFile::MappedFile(const string& path, bool shared_memory) {
+    if (shared_memory) throw DatabaseException("shared memory: not supported on this platform");
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) throw DatabaseException("snapshot: cannot open " + path);
+    buffer.resize(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    if (!f.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+        throw DatabaseException("snapshot: cannot read " + path);
+    ptr = buffer.data();
+    len = buffer.size();
+}
+
+MappedFile::~MappedFile() {}
+#else
+MappedFile::MappedFile(const string& path, bool shared_memory) {
+    const int fd = shared_memory ? shm_open(path.c_str(), O_RDONLY, 0) : open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw DatabaseException("snapshot: cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw DatabaseException("snapshot: cannot stat " + path);
+    }
+    len = static_cast<size_t>(st.st_size);
+    ino = static_cast<uint64_t>(st.st_ino);
+    void* p = mmap(nullptr, len, PROT_READ, shared_memory ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping keeps its own reference
+    if (p == MAP_FAILED) throw DatabaseException("snapshot: cannot mmap " + path);
+    ptr = static_cast<const uint8_t*>(p);
+}
+
+MappedFile::~MappedFile() {
+    if (ptr) munmap(const_cast<uint8_t*>(ptr), len);
+}
+#endif
+
+// four independent multiply-xorshift lanes over 8 byte words so that the loop is not latency bound
+uint64_t snapshot_checksum(const void* data, size_t size) {
+    constexpr uint64_t K = 0x9E3779B97F4A7C15ULL;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h[4] = {K, K ^ 1, K ^ 2, K ^ 3};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int l = 0; l < 4; l++) {
+            uint64_t w;
+            std::memcpy(&w, p + i + l * 8, 8);
+            h[l] = (h[l] ^ w) * K;
+            h[l] ^= h[l] >> 29;
+        }
+    }
+    uint64_t tail = size;
+    for (; i < size; i++) tail = (tail ^ p[i]) * K;
+    uint64_t r = tail;
+    for (int l = 0; l < 4; l++) {
+        r = (r ^ h[l]) * K;
+        r ^= r >> 32;
+    }
+    return r;
+}
+
+void snapshot_sources(const string& data_dir, SnapshotSource (&sources)[SNAPSHOT_SOURCE_COUNT]) {
+    namespace fs = std::filesystem;
+    const fs::path dir(data_dir);
+    for (size_t i = 0; i < SNAPSHOT_SOURCE_COUNT; i++) {
+        std::error_code ec_size, ec_mtime;
+        const fs::path p = dir / SNAPSHOT_SOURCES[i];
+        const auto size = fs::file_size(p, ec_size);
+        const auto mtime = fs::last_write_time(p, ec_mtime);
+        sources[i] = ec_size || ec_mtime ? SnapshotSource{0, 0}
+                        : SnapshotSource{static_cast<uint64_t>(size), static_cast<int64_t>(mtime.time_since_epoch().count())};
+    }
+}
+
+namespace {
+struct RecordWriter {
+    std::vector<uint8_t> buf;
+
+    template <typename T>
+    void put(T v) {
+        const size_t n = buf.size();
+        buf.resize(n + sizeof(T));
+        std::memcpy(buf.data() + n, &v, sizeof(T));
+    }
+    void put_str(const string& s) {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        buf.insert(buf.end(), s.begin(), s.end());
+    }
+};
+
+struct RecordReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    template <typename T>
+    T get() {
+        if (static_cast<size_t>(end - p) < sizeof(T)) throw DatabaseException("snapshot: truncated record");
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+    string get_str() {
+        const uint32_t n = get<uint32_t>();
+        if (static_cast<size_t>(end - p) < n) throw DatabaseException("snapshot: truncated record");
+        string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+inline uint64_t align_up(uint64_t x) { return (x + 63) & ~static_cast<uint64_t>(63); }
+}  // namespace
+
+bool Database::load_snapshot(const string& path, bool compact) {
+    if (!std::filesystem::exists(path)) return false;
+
+    shared_ptr<const MappedFile> file;
+    try {
+        file = make_shared<const MappedFile>(path);
+    } catch (const DatabaseException& e) {
+        std::cerr << "WARN: " << e.what() << std::endl;
+        return false;
+    }
+    return install_snapshot(file, std::filesystem::path(path).parent_path().string(), compact);
+}
+
+bool Database::install_snapshot(shared_ptr<const MappedFile> file, const string& data_dir, bool compact) {
+    auto reject = [&](const string& reason) {
+        std::cerr << "WARN: snapshot: " << reason << ", ignoring it" << std::endl;
+        return false;
+    };
+
+    SnapshotHeader h;
+    if (file->size() < sizeof(h)) return reject("truncated header");
+    std::memcpy(&h, file->data(), sizeof(h));
+    if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0) return reject("bad magic");
+    if (h.header_checksum != snapshot_checksum(&h, offsetof(SnapshotHeader, header_checksum)))
+        return reject("header checksum mismatch");
+    if (h.version != SNAPSHOT_VERSION || h.byte_order != SNAPSHOT_BYTE_ORDER || h.airport_count != AIRPORT_COUNT ||
+        h.aircraft_count != AIRCRAFT_COUNT || h.route_count != ROUTE_COUNT || h.pax_demand_size != sizeof(PaxDemand))
+        return reject("incompatible version");
+
+    // parquet files that are missing are not an error: the snapshot is then the only source we have
+    SnapshotSource sources[SNAPSHOT_SOURCE_COUNT];
+    snapshot_sources(data_dir, sources);
+    for (size_t i = 0; i < SNAPSHOT_SOURCE_COUNT; i++) {
+        if (sources[i] != SnapshotSource{0, 0} && sources[i] != h.sources[i])
+            return reject(string(SNAPSHOT_SOURCES[i]) + " has changed");
+    }
+
+    // only the sections that are actually used are verified (and therefore paged in)
+    const SnapshotSection::Kind dist_kind = compact ? SnapshotSection::COMPACT_DISTANCES : SnapshotSection::DISTANCES;
+    const size_t expected_size[SnapshotSection::COUNT] = {
+        0, 0, sizeof(PaxDemand) * ROUTE_COUNT, sizeof(double) * AIRPORT_COUNT * AIRPORT_COUNT,
+        sizeof(float) * ROUTE_COUNT
+    };
+    for (SnapshotSection::Kind k :
+         {SnapshotSection::AIRPORTS, SnapshotSection::AIRCRAFTS, SnapshotSection::PAX_DEMANDS, dist_kind}) {
+        const SnapshotSection& s = h.sections[k];
+        if (s.offset % 64 != 0 || s.offset > file->size() || s.size > file->size() - s.offset)
+            return reject("truncated file");
+        if (expected_size[k] != 0 && s.size != expected_size[k]) return reject("bad section size");
+        if (s.checksum != snapshot_checksum(file->data() + s.offset, s.size)) return reject("checksum mismatch");
+    }
+
+    // decode into temporaries first so that a bad record leaves the database untouched
+    std::vector<Airport> aps(AIRPORT_COUNT);
+    std::vector<Aircraft> acs(AIRCRAFT_COUNT);
+    try {
+        const SnapshotSection& sap = h.sections[SnapshotSection::AIRPORTS];
+        RecordReader r{file->data() + sap.offset, file->data() + sap.offset + sap.size};
+        for (Airport& ap : aps) {
+            ap.id = r.get<uint16_t>();
+            ap.name = r.get_str();
+            ap.fullname = r.get_str();
+            ap.country = r.get_str();
+            ap.continent = r.get_str();
+            ap.iata = r.get_str();
+            ap.icao = r.get_str();
+            ap.lat = r.get<double>();
+            ap.lng = r.get<double>();
+            ap.rwy = r.get<uint16_t>();
+            ap.market = r.get<uint8_t>();
+            ap.hub_cost = r.get<uint32_t>();
+            ap.rwy_codes = r.get_str();
+            ap.valid = true;
+        }
+        const SnapshotSection& sac = h.sections[SnapshotSection::AIRCRAFTS];
+        r = RecordReader{file->data() + sac.offset, file->data() + sac.offset + sac.size};
+        for (Aircraft& ac : acs) {
+            ac.id = r.get<uint16_t>();
+            ac.shortname = r.get_str();
+            ac.manufacturer = r.get_str();
+            ac.name = r.get_str();
+            ac.type = static_cast<Aircraft::Type>(r.get<uint8_t>());
+            ac.priority = r.get<uint8_t>();
+            ac.eid = r.get<uint16_t>();
+            ac.ename = r.get_str();
+            ac.speed = r.get<float>();
+            ac.fuel = r.get<float>();
+            ac.co2 = r.get<float>();
+            ac.cost = r.get<uint32_t>();
+            ac.capacity = r.get<uint32_t>();
+            ac.rwy = r.get<uint16_t>();
+            ac.check_cost = r.get<uint32_t>();
+            ac.range = r.get<uint16_t>();
+            ac.ceil = r.get<uint16_t>();
+            ac.maint = r.get<uint16_t>();
+            ac.pilots = r.get<uint8_t>();
+            ac.crew = r.get<uint8_t>();
+            ac.engineers = r.get<uint8_t>();
+            ac.technicians = r.get<uint8_t>();
+            ac.img = r.get_str();
+            ac.wingspan = r.get<uint8_t>();
+            ac.length = r.get<uint8_t>();
+            ac.speed_mod = ac.fuel_mod = ac.co2_mod = ac.fourx_mod = false;
+            ac.valid = true;
+        }
+    } catch (const DatabaseException& e) {
+        return reject(e.what());
+    }
+
+    std::move(aps.begin(), aps.end(), airports);
+    std::move(acs.begin(), acs.end(), aircrafts);
+    std::vector<PaxDemand>().swap(pax_demands_data);
+    std::vector<double>().swap(distances_data);
+    std::vector<float>().swap(compact_distances_data);
+    use_owned_tables();
+
+    snapshot = file;
+    const uint8_t* base = file->data();
+    pax_demands = reinterpret_cast<const PaxDemand*>(base + h.sections[SnapshotSection::PAX_DEMANDS].offset);
+    if (compact) {
+        compact_distances = reinterpret_cast<const float*>(base + h.sections[dist_kind].offset);
+    } else {
+        distances = reinterpret_cast<const double*>(base + h.sections[dist_kind].offset);
+    }
+    build_indices();
+    return true;
+}
+
+namespace {
+// a snapshot laid out in memory, ready to be written out
+struct SnapshotImage {
+    SnapshotHeader header;
+    RecordWriter airports;
+    RecordWriter aircrafts;
+    std::vector<double> dense;
+    std::vector<float> compact;
+    const void* payload[SnapshotSection::COUNT];
+    uint64_t total_size;
+
+    // sections first and the header last, so that a reader racing with the writer never sees a valid header
+    void copy_to(uint8_t* dst) const {
+        uint64_t pos = sizeof(header);
+        for (uint32_t k = 0; k < SnapshotSection::COUNT; k++) {
+            const SnapshotSection& s = header.sections[k];
+            std::memset(dst + pos, 0, s.offset - pos);
+            if (s.size != 0) std::memcpy(dst + s.offset, payload[k], s.size);
+            pos = s.offset + s.size;
+        }
+        std::memset(dst + pos, 0, total_size - pos);
+        std::memcpy(dst, &header, sizeof(header));
+    }
+};
+
+// route_distances: as for Database::write_snapshot, which stores both distance tables so that either mode can map its
+// table directly. nullptr for a shared-memory segment, which only stores the table the database currently uses.
+std::unique_ptr<SnapshotImage> make_snapshot_image(
+    const Database& db, const string& data_dir, const double* route_distances
+) {
+    auto img = std::make_unique<SnapshotImage>();
+    for (const Airport& ap : db.airports) {
+        img->airports.put<uint16_t>(ap.id);
+        img->airports.put_str(ap.name);
+        img->airports.put_str(ap.fullname);
+        img->airports.put_str(ap.country);
+        img->airports.put_str(ap.continent);
+        img->airports.put_str(ap.iata);
+        img->airports.put_str(ap.icao);
+        img->airports.put<double>(ap.lat);
+        img->airports.put<double>(ap.lng);
+        img->airports.put<uint16_t>(ap.rwy);
+        img->airports.put<uint8_t>(ap.market);
+        img->airports.put<uint32_t>(ap.hub_cost);
+        img->airports.put_str(ap.rwy_codes);
+    }
+    for (const Aircraft& ac : db.aircrafts) {
+        img->aircrafts.put<uint16_t>(ac.id);
+        img->aircrafts.put_str(ac.shortname);
+        img->aircrafts.put_str(ac.manufacturer);
+        img->aircrafts.put_str(ac.name);
+        img->aircrafts.put<uint8_t>(static_cast<uint8_t>(ac.type));
+        img->aircrafts.put<uint8_t>(ac.priority);
+        img->aircrafts.put<uint16_t>(ac.eid);
+        img->aircrafts.put_str(ac.ename);
+        img->aircrafts.put<float>(ac.speed);
+        img->aircrafts.put<float>(ac.fuel);
+        img->aircrafts.put<float>(ac.co2);
+        img->aircrafts.put<uint32_t>(ac.cost);
+        img->aircrafts.put<uint32_t>(ac.capacity);
+        img->aircrafts.put<uint16_t>(ac.rwy);
+        img->aircrafts.put<uint32_t>(ac.check_cost);
+        img->aircrafts.put<uint16_t>(ac.range);
+        img->aircrafts.put<uint16_t>(ac.ceil);
+        img->aircrafts.put<uint16_t>(ac.maint);
+        img->aircrafts.put<uint8_t>(ac.pilots);
+        img->aircrafts.put<uint8_t>(ac.crew);
+        img->aircrafts.put<uint8_t>(ac.engineers);
+        img->aircrafts.put<uint8_t>(ac.technicians);
+        img->aircrafts.put_str(ac.img);
+        img->aircrafts.put<uint8_t>(ac.wingspan);
+        img->aircrafts.put<uint8_t>(ac.length);
+    }
+
+    size_t dense_size = 0, compact_size = 0;
+    if (route_distances) {
+        img->dense.assign(static_cast<size_t>(AIRPORT_COUNT) * AIRPORT_COUNT, 0.0);
+        img->compact.resize(ROUTE_COUNT);
+        for (uint16_t x = 0; x < AIRPORT_COUNT; x++) {
+            for (uint16_t y = x + 1; y < AIRPORT_COUNT; y++) {
+                const uint32_t idx = Database::get_dbroute_idx(x, y);
+                img->dense[x * AIRPORT_COUNT + y] = img->dense[y * AIRPORT_COUNT + x] = route_distances[idx];
+                img->compact[idx] = static_cast<float>(route_distances[idx]);
+            }
+        }
+        img->payload[SnapshotSection::DISTANCES] = img->dense.data();
+        img->payload[SnapshotSection::COMPACT_DISTANCES] = img->compact.data();
+        dense_size = sizeof(double) * img->dense.size();
+        compact_size = sizeof(float) * img->compact.size();
+    } else if (db.compact_distances) {
+        img->payload[SnapshotSection::DISTANCES] = nullptr;
+        img->payload[SnapshotSection::COMPACT_DISTANCES] = db.compact_distances;
+        compact_size = sizeof(float) * ROUTE_COUNT;
+    } else {
+        img->payload[SnapshotSection::DISTANCES] = db.distances;
+        img->payload[SnapshotSection::COMPACT_DISTANCES] = nullptr;
+        dense_size = sizeof(double) * AIRPORT_COUNT * AIRPORT_COUNT;
+    }
+
+    img->payload[SnapshotSection::AIRPORTS] = img->airports.buf.data();
+    img->payload[SnapshotSection::AIRCRAFTS] = img->aircrafts.buf.data();
+    img->payload[SnapshotSection::PAX_DEMANDS] = db.pax_demands;
+    const size_t payload_size[SnapshotSection::COUNT] = {
+        img->airports.buf.size(), img->aircrafts.buf.size(), sizeof(PaxDemand) * ROUTE_COUNT, dense_size, compact_size
+    };
+
+    SnapshotHeader& h = img->header;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.byte_order = SNAPSHOT_BYTE_ORDER;
+    h.airport_count = AIRPORT_COUNT;
+    h.aircraft_count = AIRCRAFT_COUNT;
+    h.route_count = ROUTE_COUNT;
+    h.pax_demand_size = sizeof(PaxDemand);
+    snapshot_sources(data_dir, h.sources);
+    uint64_t offset = align_up(sizeof(h));
+    for (uint32_t k = 0; k < SnapshotSection::COUNT; k++) {
+        h.sections[k] = {offset, payload_size[k], snapshot_checksum(img->payload[k], payload_size[k])};
+        offset = align_up(offset + payload_size[k]);
+    }
+    img->total_size = offset;
+    h.header_checksum = snapshot_checksum(&h, offsetof(SnapshotHeader, header_checksum));
+
+    return img;
+}
+}  // namespace
+
+void Database::write_snapshot(const string& path, const double* route_distances) const {
+    const auto img = make_snapshot_image(*this, std::filesystem::path(path).parent_path().string(), route_distances);
+    const SnapshotHeader& h = img->header;
+
+    // write next to the destination and rename, so that a concurrent or interrupted start never sees a partial file
+    const string tmp_path = path + ".tmp";
+    {
+        std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!f) throw DatabaseException("snapshot: cannot write " + tmp_path);
+        const char zeros[64] = {};
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        uint64_t pos = sizeof(h);
+        for (uint32_t k = 0; k < SnapshotSection::COUNT; k++) {
+            f.write(zeros, h.sections[k].offset - pos);
+            f.write(static_cast<const char*>(img->payload[k]), h.sections[k].size);
+            pos = h.sections[k].offset + h.sections[k].size;
+        }
+        if (!f) {
+            f.close();
+            std::remove(tmp_path.c_str());
+            throw DatabaseException("snapshot: cannot write " + tmp_path);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::remove(tmp_path.c_str());
+        throw DatabaseException("snapshot: cannot rename " + tmp_path + ": " + ec.message());
+    }
+}
+
+#ifndef _WIN32
+// the inode of the segment, 0 if there is none. *size receives its size.
+static uint64_t shared_segment_id(const string& name, size_t* size) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return 0;
+    struct stat st;
+    const bool ok = fstat(fd, &st) == 0;
+    close(fd);
+    if (!ok) return 0;
+    if (size) *size = static_cast<size_t>(st.st_size);
+    return static_cast<uint64_t>(st.st_ino);
+}
+
+// removes the segment, unless it was replaced since it was found invalid
+static void unlink_shared_segment(const string& name, uint64_t id) {
+    if (id != 0 && shared_segment_id(name, nullptr) == id) shm_unlink(name.c_str());
+}
+#endif
+
+Database::SharedSnapshot Database::attach_shared_snapshot(
+    const string& name, const string& data_dir, bool compact, uint64_t* segment_id
+) {
+#ifdef _WIN32
+    return SharedSnapshot::MISSING;
+#else
+    size_t size = 0;
+    const uint64_t id = shared_segment_id(name, &size);
+    if (id == 0) return SharedSnapshot::MISSING;
+    if (segment_id) *segment_id = id;
+    if (size == 0) return SharedSnapshot::PENDING;  // created, not sized yet
+    shared_ptr<const MappedFile> segment;
+    try {
+        segment = make_shared<const MappedFile>(name, true);
+    } catch (const DatabaseException&) {
+        return SharedSnapshot::PENDING;  // replaced or removed meanwhile: look again
+    }
+    if (segment->id() != id) return SharedSnapshot::PENDING;
+    // the header is written last: until then, the magic is still zeroes
+    static const char no_magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    if (segment->size() >= sizeof(SnapshotHeader) &&
+        std::memcmp(segment->data() + offsetof(SnapshotHeader, magic), no_magic, sizeof(no_magic)) == 0)
+        return SharedSnapshot::PENDING;
+    return install_snapshot(segment, data_dir, compact) ? SharedSnapshot::ATTACHED : SharedSnapshot::INVALID;
+#endif
+}
+
+Database::SharedSnapshot Database::await_shared_snapshot(
+    const string& name, const string& data_dir, bool compact, uint64_t* segment_id
+) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SHARED_SNAPSHOT_TIMEOUT_MS);
+    while (true) {
+        const SharedSnapshot state = attach_shared_snapshot(name, data_dir, compact, segment_id);
+        if (state != SharedSnapshot::PENDING) return state;
+        if (std::chrono::steady_clock::now() > deadline) return SharedSnapshot::INVALID;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+void Database::share_snapshot(const string& name, const string& data_dir, bool compact) {
+#ifdef _WIN32
+    throw DatabaseException("shared memory: not supported on this platform");
+#else
+    for (int attempt = 0; attempt < 3; attempt++) {
+        if (publish_shared_snapshot(name, data_dir, compact)) {
+            attach_shared_snapshot(name, data_dir, compact);
+            return;
+        }
+        // another process published, or is publishing, under that name
+        uint64_t id = 0;
+        const SharedSnapshot state = await_shared_snapshot(name, data_dir, compact, &id);
+        if (state == SharedSnapshot::ATTACHED) return;
+        if (state == SharedSnapshot::INVALID) unlink_shared_segment(name, id);
+    }
+    throw DatabaseException("shared memory: cannot publish " + name + ", keeping a private copy");
+#endif
+}
+
+bool Database::publish_shared_snapshot(const string& name, const string& data_dir, bool compact) const {
+#ifdef _WIN32
+    throw DatabaseException("shared memory: not supported on this platform");
+#else
+    if (compact ? !compact_distances : !distances) throw DatabaseException("shared memory: no tables to publish");
+    // O_EXCL: if two processes get here at the same time, only one of them publishes
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST) return false;
+        throw DatabaseException("shared memory: cannot create " + name);
+    }
+    const auto img = make_snapshot_image(*this, data_dir, nullptr);
+    const uint64_t total_size = img->total_size;
+    auto fail = [&](const string& what) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return DatabaseException("shared memory: cannot " + what + " " + name + " (" + std::to_string(total_size) +
+                                 " B, is /dev/shm large enough?)");
+    };
+    if (ftruncate(fd, static_cast<off_t>(total_size)) != 0) throw fail("resize");
+#ifdef __linux__
+    // tmpfs pages are only allocated on first write: reserve them now to fail here instead of with SIGBUS
+    if (posix_fallocate(fd, 0, static_cast<off_t>(total_size)) != 0) throw fail("allocate");
+#endif
+    void* p = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) throw fail("mmap");
+    close(fd);
+    img->copy_to(static_cast<uint8_t*>(p));
+    munmap(p, total_size);
+    return true;
+#endif
+}
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <queue>
+
+#include "include/ext/jaro.hpp"
+#include "include/suggest.hpp"
+
+SuggestionIndex::Histogram SuggestionIndex::histogram(const string& s) {
+    Histogram h{};
+    for (unsigned char c : s) {
+        uint8_t& b = h[c % HIST_BUCKETS];
+        if (b != 255) b++;
+    }
+    return h;
+}
+
+// the string is padded with \0 on both sides so that prefixes and suffixes get their own trigrams
+template <typename Fn>
+void SuggestionIndex::for_each_trigram(const string& s, Fn fn) {
+    uint32_t gram = 0;
+    for (size_t i = 0; i <= s.size(); i++) {
+        const uint32_t c = i < s.size() ? static_cast<unsigned char>(s[i]) : 0;
+        gram = ((gram << 8) | c) & 0xFFFFFF;
+        if (i >= 1) fn(gram);
+    }
+}
+
+// jaro: m / |a| + m / |b| + (m - t / 2) / m, all over 3, where the number of matches m can never exceed the common
+// character multiset (bucketing characters only merges counts, which keeps this an upper bound) and the transposition
+// term is at most 1. the winkler boost is increasing in the jaro distance, so applying it to the bound with the
+// actual common prefix still gives an upper bound.
+double SuggestionIndex::upper_bound(const string& a, const Histogram& ha, const string& b, const Histogram& hb) {
+    const size_t al = a.size(), bl = b.size();
+    if (al == 0 || bl == 0) return 0.0;
+    if (al >= 255 || bl >= 255) return 1.0;  // saturated histograms
+
+    size_t overlap = 0;
+    for (size_t i = 0; i < HIST_BUCKETS; i++) overlap += std::min(ha[i], hb[i]);
+    const double m = static_cast<double>(std::min({overlap, al, bl}));
+    if (m == 0) return 0.0;
+    double bound = (m / static_cast<double>(al) + m / static_cast<double>(bl) + 1.0) / 3.0;
+
+    if (bound > JARO_WINKLER_BOOST_THRESHOLD) {
+        int prefix = 0;
+        for (size_t i = 0, end = std::min(std::min(al, bl), JARO_WINKLER_PREFIX_SIZE); i < end && a[i] == b[i]; i++)
+            prefix++;
+        bound += JARO_WINKLER_SCALING_FACTOR * prefix * (1.0 - bound);
+    }
+    return bound;
+}
+
+void SuggestionIndex::build(const std::vector<std::vector<string>>& fields, const std::vector<bool>& enabled) {
+    num_fields = std::min(fields.size(), MAX_FIELDS);
+    num_records = enabled.size();
+    this->fields.assign(fields.begin(), fields.begin() + num_fields);
+    hists.assign(num_fields, std::vector<Histogram>(num_records));
+    enabled_records.clear();
+    postings.clear();
+
+    for (size_t r = 0; r < num_records; r++) {
+        if (!enabled[r]) continue;
+        enabled_records.push_back(static_cast<uint16_t>(r));
+        for (size_t f = 0; f < num_fields; f++) {
+            hists[f][r] = histogram(this->fields[f][r]);
+            for_each_trigram(this->fields[f][r], [&](uint32_t gram) {
+                auto& list = postings[gram];
+                const uint32_t entry = static_cast<uint32_t>(r * MAX_FIELDS + f);
+                if (list.empty() || list.back() != entry) list.push_back(entry);
+            });
+        }
+    }
+}
+
+std::vector<SuggestionIndex::Hit> SuggestionIndex::top(const string& input, uint32_t field_mask, size_t k) const {
+    // the worst of the current top k is on top of the heap: lower score, then later record
+    auto worse = [](const Hit& a, const Hit& b) {
+        return a.score < b.score || (a.score == b.score && a.record > b.record);
+    };
+    auto cmp = [&](const Hit& a, const Hit& b) { return worse(b, a); };
+    std::priority_queue<Hit, std::vector<Hit>, decltype(cmp)> heap(cmp);
+    std::vector<bool> scored(num_records, false);
+    const JaroQuery query(input);
+
+    auto score_record = [&](uint16_t r) {
+        scored[r] = true;
+        double score = 0.0;
+        for (size_t f = 0; f < num_fields; f++) {
+            if (field_mask & (1u << f)) score = std::max(score, query.jaro_winkler(fields[f][r]));
+        }
+        const Hit hit{r, score};
+        if (heap.size() < k) {
+            heap.push(hit);
+        } else if (worse(heap.top(), hit)) {
+            heap.pop();
+            heap.push(hit);
+        }
+    };
+    if (k == 0) return {};
+
+    // 1. seed the top k with the records sharing the most trigrams with the input
+    std::vector<uint16_t> shared(num_records, 0);
+    std::vector<uint16_t> seeds;
+    for_each_trigram(input, [&](uint32_t gram) {
+        auto it = postings.find(gram);
+        if (it == postings.end()) return;
+        for (uint32_t entry : it->second) {
+            if (!(field_mask & (1u << (entry % MAX_FIELDS)))) continue;
+            const uint16_t r = static_cast<uint16_t>(entry / MAX_FIELDS);
+            if (shared[r]++ == 0) seeds.push_back(r);
+        }
+    });
+    const size_t num_seeds = std::min(seeds.size(), k * 8);
+    std::partial_sort(seeds.begin(), seeds.begin() + num_seeds, seeds.end(), [&](uint16_t a, uint16_t b) {
+        return shared[a] > shared[b] || (shared[a] == shared[b] && a < b);
+    });
+    for (size_t i = 0; i < num_seeds; i++) score_record(seeds[i]);
+
+    // 2. only score the remaining records that could still make it into the top k
+    constexpr double EPS = 1e-9;  // the bound and the exact score are computed differently
+    const Histogram input_hist = histogram(input);
+    for (uint16_t r : enabled_records) {
+        if (scored[r]) continue;
+        if (heap.size() == k) {
+            const double threshold = heap.top().score - EPS;
+            bool may_enter = false;
+            for (size_t f = 0; f < num_fields && !may_enter; f++) {
+                if (field_mask & (1u << f))
+                    may_enter = upper_bound(input, input_hist, fields[f][r], hists[f][r]) >= threshold;
+            }
+            if (!may_enter) continue;
+        }
+        score_record(r);
+    }
+
+    std::vector<Hit> hits(heap.size());
+    for (size_t i = hits.size(); i-- > 0;) {
+        hits[i] = heap.top();
+        heap.pop();
+    }
+    return hits;
+}
+
+void PrefixIndex::build(
+    const std::vector<std::vector<string>>& keys, const std::vector<uint64_t>& rank, const std::vector<bool>& enabled
+) {
+    entries.clear();
+    by_rank.clear();
+    ranks = rank;
+    for (size_t r = 0; r < keys.size(); r++) {
+        if (!enabled[r]) continue;
+        by_rank.push_back(static_cast<uint16_t>(r));
+        for (const string& key : keys[r]) {
+            if (!key.empty()) entries.push_back({key, static_cast<uint16_t>(r)});
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.key < b.key || (a.key == b.key && a.record < b.record);
+    });
+    entries.erase(
+        std::unique(
+            entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.key == b.key && a.record == b.record; }
+        ),
+        entries.end()
+    );
+    std::stable_sort(by_rank.begin(), by_rank.end(), [&](uint16_t a, uint16_t b) { return ranks[a] > ranks[b]; });
+}
+
+std::vector<uint16_t> PrefixIndex::complete(const string& prefix, size_t n) const {
+    if (n == 0) return {};
+    if (prefix.empty()) return std::vector<uint16_t>(by_rank.begin(), by_rank.begin() + std::min(n, by_rank.size()));
+
+    // best first, at most n records
+    std::vector<uint16_t> top;
+    top.reserve(n + 1);
+    auto better = [&](uint16_t a, uint16_t b) { return ranks[a] > ranks[b] || (ranks[a] == ranks[b] && a < b); };
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), prefix, [](const Entry& e, const string& p) {
+        return e.key < p;
+    });
+    for (; it != entries.end() && it->key.compare(0, prefix.size(), prefix) == 0; ++it) {
+        const uint16_t r = it->record;
+        if (top.size() == n && !better(r, top.back())) continue;
+        if (std::find(top.begin(), top.end(), r) != top.end()) continue;
+        top.insert(std::upper_bound(top.begin(), top.end(), r, better), r);
+        if (top.size() > n) top.pop_back();
+    }
+    return top;
+}
@@ -3,9 +3,10 @@ from . import aircraft
 from . import airport
 from . import db
 from . import demand
+from . import fleet
 from . import game
 from . import log
 from . import route
 from . import ticket
-__all__ = ['aircraft', 'airport', 'db', 'demand', 'game', 'log', 'route', 'ticket']
+__all__ = ['aircraft', 'airport', 'db', 'demand', 'fleet', 'game', 'log', 'route', 'ticket']
 __version__: str = '0.1.8'
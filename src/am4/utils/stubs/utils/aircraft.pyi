@@ -3,6 +3,13 @@ import am4.utils.game
 import typing
 __all__ = ['Aircraft']
 class Aircraft:
+    class BatchResult:
+        @property
+        def ac(self) -> Aircraft | None:
+            ...
+        @property
+        def suggestions(self) -> list[Aircraft.Suggestion]:
+            ...
     class CargoConfig:
         class Algorithm:
             """
@@ -100,15 +107,18 @@ class Aircraft:
               YJF
             
               YFJ
+            
+              BEST
             """
             AUTO: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.AUTO: 0>
+            BEST: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.BEST: 7>
             FJY: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.FJY: 1>
             FYJ: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.FYJ: 2>
             JFY: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.JFY: 3>
             JYF: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.JYF: 4>
             YFJ: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.YFJ: 6>
             YJF: typing.ClassVar[Aircraft.PaxConfig.Algorithm]  # value = <Algorithm.YJF: 5>
-            __members__: typing.ClassVar[dict[str, Aircraft.PaxConfig.Algorithm]]  # value = {'AUTO': <Algorithm.AUTO: 0>, 'FJY': <Algorithm.FJY: 1>, 'FYJ': <Algorithm.FYJ: 2>, 'JFY': <Algorithm.JFY: 3>, 'JYF': <Algorithm.JYF: 4>, 'YJF': <Algorithm.YJF: 5>, 'YFJ': <Algorithm.YFJ: 6>}
+            __members__: typing.ClassVar[dict[str, Aircraft.PaxConfig.Algorithm]]  # value = {'AUTO': <Algorithm.AUTO: 0>, 'FJY': <Algorithm.FJY: 1>, 'FYJ': <Algorithm.FYJ: 2>, 'JFY': <Algorithm.JFY: 3>, 'JYF': <Algorithm.JYF: 4>, 'YJF': <Algorithm.YJF: 5>, 'YFJ': <Algorithm.YFJ: 6>, 'BEST': <Algorithm.BEST: 7>}
             def __eq__(self, other: typing.Any) -> bool:
                 ...
             def __getstate__(self) -> int:
@@ -256,11 +266,20 @@ class Aircraft:
         def value(self) -> int:
             ...
     @staticmethod
+    def autocomplete(prefix: str, n: int = 5) -> list[Aircraft]:
+        ...
+    @staticmethod
     def search(s: str, user: am4.utils.game.User = am4.utils.game.User.Default()) -> Aircraft.SearchResult:
         ...
     @staticmethod
+    def search_many(queries: list[str], user: am4.utils.game.User = am4.utils.game.User.Default()) -> list[Aircraft.BatchResult]:
+        ...
+    @staticmethod
     def suggest(s: Aircraft.ParseResult) -> list[Aircraft.Suggestion]:
         ...
+    @staticmethod
+    def suggest_many(queries: list[str], user: am4.utils.game.User = am4.utils.game.User.Default()) -> list[Aircraft.BatchResult]:
+        ...
     def __repr__(self) -> str:
         ...
     def to_dict(self) -> dict:
@@ -2,6 +2,13 @@ from __future__ import annotations
 import typing
 __all__ = ['Airport']
 class Airport:
+    class BatchResult:
+        @property
+        def ap(self) -> Airport | None:
+            ...
+        @property
+        def suggestions(self) -> list[Airport.Suggestion]:
+            ...
     class ParseResult:
         def __init__(self, arg0: Airport.SearchType, arg1: str) -> None:
             ...
@@ -79,11 +86,20 @@ class Airport:
         def score(self) -> float:
             ...
     @staticmethod
+    def autocomplete(prefix: str, n: int = 5) -> list[Airport]:
+        ...
+    @staticmethod
     def search(s: str) -> Airport.SearchResult:
         ...
     @staticmethod
+    def search_many(queries: list[str]) -> list[Airport.BatchResult]:
+        ...
+    @staticmethod
     def suggest(s: Airport.ParseResult) -> list[Airport.Suggestion]:
         ...
+    @staticmethod
+    def suggest_many(queries: list[str]) -> list[Airport.BatchResult]:
+        ...
     def __repr__(self) -> str:
         ...
     def to_dict(self) -> dict:
@@ -1,10 +1,14 @@
 from __future__ import annotations
 import typing
 from . import utils
-__all__ = ['DatabaseException', 'init', 'utils']
+__all__ = ['DatabaseException', 'get_num_threads', 'init', 'set_num_threads', 'utils']
 class DatabaseException(Exception):
     pass
 def _debug_query(query: str) -> None:
     ...
-def init(home_dir: str | None = None) -> None:
+def get_num_threads() -> int:
+    ...
+def init(home_dir: str | None = None, compact_distances: bool = False, use_snapshot: bool = True, shared_memory: str | None = None) -> None:
+    ...
+def set_num_threads(num_threads: int) -> None:
     ...
@@ -0,0 +1,34 @@
+from __future__ import annotations
+import am4.utils.aircraft
+import am4.utils.airport
+import am4.utils.game
+import am4.utils.route
+__all__ = ['FleetPlanner']
+class FleetPlanner:
+    class Assignment:
+        @property
+        def ac_route(self) -> am4.utils.route.AircraftRoute:
+            ...
+        @property
+        def aircraft_idx(self) -> int:
+            ...
+        @property
+        def daily_profit(self) -> float:
+            ...
+        @property
+        def destination(self) -> am4.utils.airport.Airport:
+            ...
+    class Plan:
+        @property
+        def assignments(self) -> list[FleetPlanner.Assignment]:
+            ...
+        @property
+        def cost(self) -> float:
+            ...
+        @property
+        def daily_profit(self) -> float:
+            ...
+    def __init__(self, ap0: am4.utils.airport.Airport, aircraft: list[am4.utils.aircraft.Aircraft], options: am4.utils.route.AircraftRoute.Options = am4.utils.route.AircraftRoute.Options(), user: am4.utils.game.User = am4.utils.game.User.Default()) -> None:
+        ...
+    def get(self, max_aircraft: int, budget: float = 0.0, max_exchanges: int = 1000) -> FleetPlanner.Plan:
+        ...
@@ -5,9 +5,49 @@ import am4.utils.demand
 import am4.utils.game
 import am4.utils.ticket
 import typing
-__all__ = ['AircraftRoute', 'Destination', 'Route', 'RoutesSearch', 'SameOdException']
+__all__ = ['AircraftRoute', 'Destination', 'GlobalRoutesSearch', 'HubSearch', 'ReverseRoutesSearch', 'Route', 'RouteColumns', 'RoutesSearch', 'SameOdException']
 class AircraftRoute:
     class Options:
+        class CIMode:
+            """
+            Members:
+            
+              MAX
+            
+              PROFIT
+            
+              CONTRIBUTION
+            """
+            CONTRIBUTION: typing.ClassVar[AircraftRoute.Options.CIMode]  # value = <CIMode.CONTRIBUTION: 2>
+            MAX: typing.ClassVar[AircraftRoute.Options.CIMode]  # value = <CIMode.MAX: 0>
+            PROFIT: typing.ClassVar[AircraftRoute.Options.CIMode]  # value = <CIMode.PROFIT: 1>
+            __members__: typing.ClassVar[dict[str, AircraftRoute.Options.CIMode]]  # value = {'MAX': <CIMode.MAX: 0>, 'PROFIT': <CIMode.PROFIT: 1>, 'CONTRIBUTION': <CIMode.CONTRIBUTION: 2>}
+            def __eq__(self, other: typing.Any) -> bool:
+                ...
+            def __getstate__(self) -> int:
+                ...
+            def __hash__(self) -> int:
+                ...
+            def __index__(self) -> int:
+                ...
+            def __init__(self, value: int) -> None:
+                ...
+            def __int__(self) -> int:
+                ...
+            def __ne__(self, other: typing.Any) -> bool:
+                ...
+            def __repr__(self) -> str:
+                ...
+            def __setstate__(self, state: int) -> None:
+                ...
+            def __str__(self) -> str:
+                ...
+            @property
+            def name(self) -> str:
+                ...
+            @property
+            def value(self) -> int:
+                ...
         class SortBy:
             """
             Members:
@@ -15,10 +55,25 @@ class AircraftRoute:
               PER_TRIP
             
               PER_AC_PER_DAY
+            
+              PER_FLIGHT_HOUR
+            
+              PER_AC_COST
+            
+              CONTRIBUTION_PER_AC_PER_DAY
+            
+              NET_OF_HUB_COST
+            
+              WEIGHTED
             """
+            CONTRIBUTION_PER_AC_PER_DAY: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.CONTRIBUTION_PER_AC_PER_DAY: 4>
+            NET_OF_HUB_COST: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.NET_OF_HUB_COST: 5>
+            PER_AC_COST: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.PER_AC_COST: 3>
             PER_AC_PER_DAY: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.PER_AC_PER_DAY: 1>
+            PER_FLIGHT_HOUR: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.PER_FLIGHT_HOUR: 2>
             PER_TRIP: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.PER_TRIP: 0>
-            __members__: typing.ClassVar[dict[str, AircraftRoute.Options.SortBy]]  # value = {'PER_TRIP': <SortBy.PER_TRIP: 0>, 'PER_AC_PER_DAY': <SortBy.PER_AC_PER_DAY: 1>}
+            WEIGHTED: typing.ClassVar[AircraftRoute.Options.SortBy]  # value = <SortBy.WEIGHTED: 6>
+            __members__: typing.ClassVar[dict[str, AircraftRoute.Options.SortBy]]  # value = {'PER_TRIP': <SortBy.PER_TRIP: 0>, 'PER_AC_PER_DAY': <SortBy.PER_AC_PER_DAY: 1>, 'PER_FLIGHT_HOUR': <SortBy.PER_FLIGHT_HOUR: 2>, 'PER_AC_COST': <SortBy.PER_AC_COST: 3>, 'CONTRIBUTION_PER_AC_PER_DAY': <SortBy.CONTRIBUTION_PER_AC_PER_DAY: 4>, 'NET_OF_HUB_COST': <SortBy.NET_OF_HUB_COST: 5>, 'WEIGHTED': <SortBy.WEIGHTED: 6>}
             def __eq__(self, other: typing.Any) -> bool:
                 ...
             def __getstate__(self) -> int:
@@ -85,18 +140,30 @@ class AircraftRoute:
             @property
             def value(self) -> int:
                 ...
+        amortisation_days: float
+        ci_mode: AircraftRoute.Options.CIMode
         config_algorithm: None | am4.utils.aircraft.Aircraft.PaxConfig.Algorithm | am4.utils.aircraft.Aircraft.CargoConfig.Algorithm
         max_distance: float
         max_flight_time: float
         sort_by: AircraftRoute.Options.SortBy
+        sort_weights: list[tuple[AircraftRoute.Options.SortBy, float]]
         tpd_mode: AircraftRoute.Options.TPDMode
         trips_per_day_per_ac: int
-        def __init__(self, tpd_mode: AircraftRoute.Options.TPDMode = TPDMode.AUTO, trips_per_day_per_ac: int = 1, max_distance: float = 20015.086796020572, max_flight_time: float = 24.0, config_algorithm: None | am4.utils.aircraft.Aircraft.PaxConfig.Algorithm | am4.utils.aircraft.Aircraft.CargoConfig.Algorithm = None, sort_by: AircraftRoute.Options.SortBy = SortBy.PER_TRIP) -> None:
+        def __init__(self, tpd_mode: AircraftRoute.Options.TPDMode = TPDMode.AUTO, trips_per_day_per_ac: int = 1, max_distance: float = 20015.086796020572, max_flight_time: float = 24.0, config_algorithm: None | am4.utils.aircraft.Aircraft.PaxConfig.Algorithm | am4.utils.aircraft.Aircraft.CargoConfig.Algorithm = None, sort_by: AircraftRoute.Options.SortBy = SortBy.PER_TRIP, ci_mode: AircraftRoute.Options.CIMode = CIMode.MAX, sort_weights: list[tuple[AircraftRoute.Options.SortBy, float]] = [], amortisation_days: float = 365.0) -> None:
             ...
     class Stopover:
         @staticmethod
+        def cache_clear() -> None:
+            ...
+        @staticmethod
+        def cache_stats() -> dict:
+            ...
+        @staticmethod
         def find_by_efficiency(origin: am4.utils.airport.Airport, destination: am4.utils.airport.Airport, aircraft: am4.utils.aircraft.Aircraft, game_mode: am4.utils.game.User.GameMode) -> AircraftRoute.Stopover:
             ...
+        @staticmethod
+        def set_cache_capacity(capacity: int) -> None:
+            ...
         def __repr__(self) -> str:
             ...
         def to_dict(self) -> dict:
@@ -258,6 +325,38 @@ class Destination:
     @property
     def airport(self) -> am4.utils.airport.Airport:
         ...
+class GlobalRoutesSearch:
+    Result = RouteColumns
+    def __init__(self, ac: am4.utils.aircraft.Aircraft, options: AircraftRoute.Options = AircraftRoute.Options(), user: am4.utils.game.User = am4.utils.game.User.Default()) -> None:
+        ...
+    def get(self, top_k: int = 1000, both_directions: bool = True) -> RouteColumns:
+        ...
+class HubSearch:
+    class Hub:
+        @property
+        def airport(self) -> am4.utils.airport.Airport:
+            ...
+        @property
+        def num_routes(self) -> int:
+            ...
+        @property
+        def routes_profit(self) -> float:
+            ...
+        @property
+        def score(self) -> float:
+            ...
+    @staticmethod
+    def clear_cache() -> None:
+        ...
+    def __init__(self, ac: am4.utils.aircraft.Aircraft, options: AircraftRoute.Options = AircraftRoute.Options(), user: am4.utils.game.User = am4.utils.game.User.Default()) -> None:
+        ...
+    def get(self, top_n: int = 10, amortisation_days: float = 365.0, top_k: int = 0) -> list[HubSearch.Hub]:
+        ...
+class ReverseRoutesSearch:
+    def __init__(self, ap1: am4.utils.airport.Airport, ac: am4.utils.aircraft.Aircraft, options: AircraftRoute.Options = AircraftRoute.Options(), user: am4.utils.game.User = am4.utils.game.User.Default()) -> None:
+        ...
+    def get(self, top_k: int = 0) -> list[Destination]:
+        ...
 class Route:
     @staticmethod
     @typing.overload
@@ -283,12 +382,219 @@ class Route:
     @property
     def valid(self) -> bool:
         ...
+class RouteColumns:
+    class StringColumn:
+        def __len__(self) -> int:
+            ...
+        def tolist(self) -> list[str]:
+            ...
+        @property
+        def data(self) -> memoryview:
+            ...
+        @property
+        def offsets(self) -> memoryview:
+            ...
+    def __len__(self) -> int:
+        ...
+    @property
+    def acheck_cost(self) -> memoryview:
+        ...
+    @property
+    def ci(self) -> memoryview:
+        ...
+    @property
+    def co2(self) -> memoryview:
+        ...
+    @property
+    def config_f(self) -> memoryview:
+        ...
+    @property
+    def config_h(self) -> memoryview:
+        ...
+    @property
+    def config_j(self) -> memoryview:
+        ...
+    @property
+    def config_l(self) -> memoryview:
+        ...
+    @property
+    def config_y(self) -> memoryview:
+        ...
+    @property
+    def contribution(self) -> memoryview:
+        ...
+    @property
+    def demand_f(self) -> memoryview:
+        ...
+    @property
+    def demand_h(self) -> memoryview:
+        ...
+    @property
+    def demand_j(self) -> memoryview:
+        ...
+    @property
+    def demand_l(self) -> memoryview:
+        ...
+    @property
+    def demand_y(self) -> memoryview:
+        ...
+    @property
+    def destination_country(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def destination_iata(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def destination_icao(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def destination_id(self) -> memoryview:
+        ...
+    @property
+    def destination_lat(self) -> memoryview:
+        ...
+    @property
+    def destination_lng(self) -> memoryview:
+        ...
+    @property
+    def destination_name(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def direct_distance(self) -> memoryview:
+        ...
+    @property
+    def flight_time(self) -> memoryview:
+        ...
+    @property
+    def fuel(self) -> memoryview:
+        ...
+    @property
+    def full_distance(self) -> memoryview:
+        ...
+    @property
+    def income(self) -> memoryview:
+        ...
+    @property
+    def max_income(self) -> memoryview:
+        ...
+    @property
+    def num_ac(self) -> memoryview:
+        ...
+    @property
+    def origin_country(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def origin_iata(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def origin_icao(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def origin_id(self) -> memoryview:
+        ...
+    @property
+    def origin_lat(self) -> memoryview:
+        ...
+    @property
+    def origin_lng(self) -> memoryview:
+        ...
+    @property
+    def origin_name(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def profit(self) -> memoryview:
+        ...
+    @property
+    def repair_cost(self) -> memoryview:
+        ...
+    @property
+    def stopover_country(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def stopover_iata(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def stopover_icao(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def stopover_id(self) -> memoryview:
+        ...
+    @property
+    def stopover_name(self) -> RouteColumns.StringColumn:
+        ...
+    @property
+    def ticket_f(self) -> memoryview:
+        ...
+    @property
+    def ticket_h(self) -> memoryview:
+        ...
+    @property
+    def ticket_j(self) -> memoryview:
+        ...
+    @property
+    def ticket_l(self) -> memoryview:
+        ...
+    @property
+    def ticket_y(self) -> memoryview:
+        ...
+    @property
+    def trips_per_day_per_ac(self) -> memoryview:
+        ...
 class RoutesSearch:
+    class Objective:
+        """
+        Members:
+        
+          PROFIT_PER_DAY
+        
+          CONTRIBUTION_PER_DAY
+        
+          FLIGHT_TIME
+        
+          CO2
+        """
+        CO2: typing.ClassVar[RoutesSearch.Objective]  # value = <Objective.CO2: 3>
+        CONTRIBUTION_PER_DAY: typing.ClassVar[RoutesSearch.Objective]  # value = <Objective.CONTRIBUTION_PER_DAY: 1>
+        FLIGHT_TIME: typing.ClassVar[RoutesSearch.Objective]  # value = <Objective.FLIGHT_TIME: 2>
+        PROFIT_PER_DAY: typing.ClassVar[RoutesSearch.Objective]  # value = <Objective.PROFIT_PER_DAY: 0>
+        __members__: typing.ClassVar[dict[str, RoutesSearch.Objective]]  # value = {'PROFIT_PER_DAY': <Objective.PROFIT_PER_DAY: 0>, 'CONTRIBUTION_PER_DAY': <Objective.CONTRIBUTION_PER_DAY: 1>, 'FLIGHT_TIME': <Objective.FLIGHT_TIME: 2>, 'CO2': <Objective.CO2: 3>}
+        def __eq__(self, other: typing.Any) -> bool:
+            ...
+        def __getstate__(self) -> int:
+            ...
+        def __hash__(self) -> int:
+            ...
+        def __index__(self) -> int:
+            ...
+        def __init__(self, value: int) -> None:
+            ...
+        def __int__(self) -> int:
+            ...
+        def __ne__(self, other: typing.Any) -> bool:
+            ...
+        def __repr__(self) -> str:
+            ...
+        def __setstate__(self, state: int) -> None:
+            ...
+        def __str__(self) -> str:
+            ...
+        @property
+        def name(self) -> str:
+            ...
+        @property
+        def value(self) -> int:
+            ...
     def __init__(self, ap0: am4.utils.airport.Airport, ac: am4.utils.aircraft.Aircraft, options: AircraftRoute.Options = AircraftRoute.Options(), user: am4.utils.game.User = am4.utils.game.User.Default()) -> None:
         ...
-    def _get_columns(self, arg0: list[Destination]) -> dict[str, list]:
+    def get(self, top_k: int = 0) -> list[Destination]:
+        ...
+    @typing.overload
+    def get_columns(self, top_k: int = 0) -> RouteColumns:
+        ...
+    @typing.overload
+    def get_columns(self, destinations: list[Destination]) -> RouteColumns:
         ...
-    def get(self) -> list[Destination]:
+    def get_pareto_front(self, objectives: list[RoutesSearch.Objective] = [Objective.PROFIT_PER_DAY, Objective.CONTRIBUTION_PER_DAY]) -> list[Destination]:
         ...
 class SameOdException(Exception):
     pass
@@ -0,0 +1,16 @@
+#pragma once
+#include <iostream>
+
+// minimal assertions for the C++ tests run by ctest: failures are reported and the test returns nonzero
+inline int check_failures = 0;
+
+#define CHECK(cond)                                                                                  \
+    do {                                                                                             \
+        if (!(cond) && check_failures++ < 20)                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl;    \
+    } while (0)
+
+inline int check_result(const char* name) {
+    std::cout << name << ": " << (check_failures ? "FAILED" : "ok") << std::endl;
+    return check_failures ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+// route evaluation must not touch the heap for the destinations RoutesSearch rejects. this replaces the global
+// operator new, so it is a test executable of its own.
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+
+#include "check.hpp"
+#include "db.hpp"
+#include "route.hpp"
+
+static std::atomic<size_t> num_allocations{0};
+
+void* operator new(size_t size) {
+    num_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+constexpr int SKIPPED = 77;  // SKIP_RETURN_CODE in CMakeLists.txt
+
+int main() {
+    // run from src/am4/utils, see add_test. routes.parquet is downloaded by the python package on first use.
+    if (!std::filesystem::exists("data/routes.parquet")) {
+        std::cout << "test_alloc: data/routes.parquet not found, skipping" << std::endl;
+        return SKIPPED;
+    }
+    init(".", false, false);
+    const auto& db = Database::Client();
+
+    const Airport ap0 = *Airport::search("BAH").ap;
+    const Aircraft ac = *Aircraft::search("a388[sfc]").ac;
+    const User user = User::Default();
+    StopoverCache::Default();  // allocated once, on first use
+    const uint16_t o_idx = db->airport_id_hashtable[ap0.id];
+    size_t rejected = 0, allocating = 0;
+    for (const auto& options : {AircraftRoute::Options(AircraftRoute::Options::TPDMode::AUTO),
+                                AircraftRoute::Options(AircraftRoute::Options::TPDMode::STRICT, 20)}) {
+        for (uint16_t d_idx = 0; d_idx < AIRPORT_COUNT; d_idx++) {
+            if (d_idx == o_idx) continue;
+            const size_t before = num_allocations;
+            const auto ar = AircraftRoute::Compact::create(o_idx, d_idx, ac, options, user);
+            if (ar.valid) continue;
+            rejected++;
+            if (num_allocations != before) allocating++;
+        }
+    }
+    std::cout << "rejected destinations: " << rejected << ", of which allocating: " << allocating << std::endl;
+    CHECK(rejected > 0);
+    CHECK(allocating == 0);
+    return check_result("test_alloc");
+}
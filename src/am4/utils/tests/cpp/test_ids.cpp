@@ -0,0 +1,115 @@
+// the compile-time id tables of ids.hpp against the run-time tables they replaced, rebuilt here verbatim
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+#include "check.hpp"
+#include "db.hpp"
+
+static const uint16_t apid_breakpoints[] = {
+    52,   178,  248,  318,  538,  542,  544,  552,  558,  562,  570,  572,  577,  597,  1110, 1130, 1162, 1200, 1249,
+    1265, 1306, 1309, 1311, 1313, 1326, 1328, 1356, 1358, 1378, 1381, 1388, 1391, 1468, 1481, 1513, 1528, 1532, 1537,
+    1540, 1541, 1543, 1571, 1592, 1598, 1625, 1683, 1696, 2382, 2400, 2533, 2557, 2559, 2566, 2573, 2577, 2591, 2597,
+    2610, 2627, 2630, 2646, 2648, 2656, 2660, 2662, 2664, 2665, 2667, 2673, 3053, 3194, 3506, 3508, 3550, 3899, 3982
+};
+static const uint16_t missing_apids[] = {
+    52,   178,  248,  318,  538,  542,  544,  552,  558,  562,  571,  572,  577,  597,  1110, 1130, 1162, 1200, 1249,
+    1265, 1306, 1310, 1311, 1313, 1326, 1328, 1356, 1358, 1378, 1381, 1388, 1391, 1468, 1481, 1513, 1528, 1532, 1537,
+    1540, 1542, 1543, 1571, 1592, 1598, 1625, 1683, 1696, 2382, 2400, 2533, 2557, 2559, 2566, 2573, 2577, 2591, 2597,
+    2610, 2627, 2630, 2647, 2648, 2656, 2660, 2662, 2664, 2666, 2667, 2673, 3053, 3194, 3507, 3508, 3550, 3899
+};
+static const uint16_t missing_acids[] = {54,  57,  65,  70,  77,  78,  79,  80,  81,  82,  83,  84,  88,  98,  121, 122,
+                                         123, 125, 174, 175, 176, 188, 217, 223, 224, 225, 235, 236, 237, 238, 239, 240,
+                                         261, 262, 263, 264, 265, 278, 279, 280, 286, 296, 297, 301, 319, 354};
+static const std::map<uint16_t, uint16_t> idx_id_map{
+    {1, 0},     {2, 4},     {3, 7},     {4, 8},     {5, 10},    {6, 12},    {7, 14},    {8, 17},    {9, 21},
+    {10, 22},   {11, 23},   {12, 24},   {13, 25},   {14, 29},   {15, 30},   {16, 32},   {17, 34},   {18, 36},
+    {19, 37},   {20, 38},   {21, 39},   {22, 41},   {23, 42},   {24, 43},   {25, 46},   {26, 47},   {27, 48},
+    {28, 49},   {29, 50},   {30, 51},   {31, 52},   {32, 53},   {33, 57},   {34, 59},   {35, 60},   {36, 61},
+    {37, 64},   {38, 66},   {39, 69},   {40, 72},   {41, 73},   {42, 74},   {43, 75},   {44, 76},   {45, 77},
+    {46, 78},   {47, 79},   {48, 81},   {49, 82},   {50, 84},   {51, 85},   {52, 89},   {53, 93},   {55, 99},
+    {56, 105},  {58, 106},  {59, 107},  {60, 108},  {61, 109},  {62, 112},  {63, 115},  {64, 118},  {66, 120},
+    {67, 122},  {68, 124},  {69, 127},  {71, 129},  {72, 133},  {73, 137},  {74, 140},  {75, 143},  {76, 146},
+    {85, 147},  {86, 148},  {87, 149},  {89, 151},  {90, 152},  {91, 153},  {92, 154},  {93, 155},  {94, 157},
+    {95, 158},  {96, 159},  {97, 160},  {99, 161},  {100, 162}, {101, 163}, {102, 164}, {103, 166}, {104, 167},
+    {105, 168}, {106, 169}, {107, 170}, {108, 171}, {109, 172}, {110, 173}, {111, 174}, {112, 175}, {113, 178},
+    {114, 180}, {115, 182}, {116, 183}, {117, 184}, {118, 185}, {119, 186}, {120, 187}, {124, 190}, {126, 191},
+    {127, 192}, {128, 193}, {129, 194}, {130, 195}, {131, 196}, {132, 197}, {133, 198}, {134, 199}, {135, 200},
+    {136, 201}, {137, 202}, {138, 203}, {139, 204}, {140, 205}, {141, 206}, {142, 207}, {143, 208}, {144, 209},
+    {145, 210}, {146, 211}, {147, 212}, {148, 213}, {149, 214}, {150, 216}, {151, 217}, {152, 218}, {153, 219},
+    {154, 220}, {155, 221}, {156, 222}, {157, 223}, {158, 224}, {159, 225}, {160, 226}, {161, 227}, {162, 228},
+    {163, 229}, {164, 230}, {165, 231}, {166, 232}, {167, 234}, {168, 235}, {169, 236}, {170, 238}, {171, 241},
+    {172, 242}, {173, 243}, {177, 246}, {178, 247}, {179, 248}, {180, 249}, {181, 250}, {182, 251}, {183, 252},
+    {184, 253}, {185, 254}, {186, 255}, {187, 256}, {189, 257}, {190, 258}, {191, 259}, {192, 260}, {193, 261},
+    {194, 262}, {195, 264}, {196, 265}, {197, 266}, {198, 267}, {199, 268}, {200, 269}, {201, 270}, {202, 272},
+    {203, 273}, {204, 274}, {205, 276}, {206, 277}, {207, 278}, {208, 279}, {209, 280}, {210, 281}, {211, 282},
+    {212, 283}, {213, 284}, {214, 285}, {215, 286}, {216, 287}, {218, 288}, {219, 289}, {220, 290}, {221, 291},
+    {222, 292}, {226, 293}, {227, 296}, {228, 299}, {229, 300}, {230, 303}, {231, 304}, {232, 305}, {233, 307},
+    {234, 309}, {241, 310}, {242, 313}, {243, 319}, {244, 320}, {245, 322}, {246, 323}, {247, 324}, {248, 325},
+    {249, 326}, {250, 328}, {251, 329}, {252, 330}, {253, 331}, {254, 332}, {255, 333}, {256, 334}, {257, 335},
+    {258, 336}, {259, 337}, {260, 338}, {266, 339}, {267, 340}, {268, 341}, {269, 343}, {270, 344}, {271, 345},
+    {272, 348}, {273, 349}, {274, 350}, {275, 351}, {276, 352}, {277, 354}, {281, 355}, {282, 356}, {283, 357},
+    {284, 358}, {285, 359}, {287, 360}, {288, 362}, {289, 363}, {290, 364}, {291, 365}, {292, 366}, {293, 367},
+    {294, 368}, {295, 369}, {298, 370}, {299, 371}, {300, 372}, {302, 374}, {303, 377}, {304, 379}, {305, 380},
+    {306, 381}, {307, 383}, {308, 384}, {309, 385}, {310, 386}, {311, 390}, {312, 394}, {313, 395}, {314, 396},
+    {315, 397}, {316, 399}, {317, 400}, {318, 401}, {320, 405}, {321, 407}, {322, 409}, {323, 413}, {324, 417},
+    {325, 418}, {326, 419}, {327, 420}, {328, 421}, {329, 422}, {330, 423}, {331, 424}, {332, 425}, {333, 426},
+    {334, 427}, {335, 428}, {336, 432}, {337, 434}, {338, 435}, {339, 436}, {340, 438}, {341, 439}, {342, 440},
+    {343, 441}, {344, 442}, {345, 443}, {346, 444}, {347, 445}, {348, 446}, {349, 447}, {350, 448}, {351, 449},
+    {352, 450}, {353, 451}, {355, 453}, {356, 454}, {357, 455}, {358, 457}, {359, 459}, {360, 460}, {361, 464},
+    {362, 468}, {363, 471}, {364, 474}, {365, 475}, {366, 477}, {367, 479}, {368, 480}, {369, 482}, {370, 483},
+    {371, 484}, {372, 485}, {373, 486}, {374, 487}, {375, 488}, {376, 489}, {377, 491}
+};
+
+// the previous Database::get_aircraft_idx_by_id
+static uint16_t old_aircraft_idx_by_id(uint16_t id, uint8_t priority) {
+    auto search = idx_id_map.find(id);
+    if (search != idx_id_map.end()) {
+        auto next = std::next(search);
+        if (next != idx_id_map.end()) {
+            if (priority > next->second - search->second - 1) priority = 0;
+        }
+        return static_cast<uint16_t>(search->second + priority);
+    }
+    return 0;
+}
+
+int main() {
+    // the breakpoint loop of the previous build_indices
+    uint16_t airport_id_hashtable[AIRPORT_ID_MAX + 1] = {};
+    uint16_t start_bp = 1, offset = 1;
+    for (uint16_t bp : apid_breakpoints) {
+        for (uint16_t j = start_bp; j <= bp; j++) {
+            airport_id_hashtable[j] = static_cast<uint16_t>(j - offset);
+        }
+        offset++;
+        start_bp = static_cast<uint16_t>(bp + 1);
+    }
+    for (int id = 0; id <= AIRPORT_ID_MAX; id++) CHECK(Database::airport_id_hashtable[id] == airport_id_hashtable[id]);
+    CHECK(Database::airport_id_hashtable[AIRPORT_ID_MAX] == AIRPORT_COUNT - 1);
+
+    auto listed = [](const auto& ids, uint32_t id) {
+        return std::find(std::begin(ids), std::end(ids), id) != std::end(ids);
+    };
+    for (uint32_t id = 0; id <= UINT16_MAX; id++) {
+        CHECK(MISSING_APID_SET.test(id) == listed(missing_apids, id));
+        CHECK(MISSING_ACID_SET.test(id) == listed(missing_acids, id));
+    }
+
+    for (uint16_t id = 0; id <= AIRCRAFT_ID_MAX + 8; id++) {
+        for (int priority = 0; priority <= UINT8_MAX; priority++) {
+            const uint16_t expected = old_aircraft_idx_by_id(id, static_cast<uint8_t>(priority));
+            const uint16_t idx = Database::get_aircraft_idx_by_id(id, static_cast<uint8_t>(priority));
+            if (id == AIRCRAFT_ID_MAX && priority > 0) {
+                // the last id had no next entry to bound its priority: the old table indexed past `aircrafts`
+                CHECK(expected == AIRCRAFT_COUNT - 1 + priority);
+                CHECK(idx == AIRCRAFT_COUNT - 1);
+            } else {
+                CHECK(idx == expected);
+            }
+            // every id get_aircraft_by_id accepts resolves within `aircrafts`, whatever the priority
+            if (id <= AIRCRAFT_ID_SEARCH_MAX && !MISSING_ACID_SET.test(id)) CHECK(idx < AIRCRAFT_COUNT);
+        }
+    }
+    return check_result("test_ids");
+}
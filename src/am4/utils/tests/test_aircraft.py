@@ -79,3 +79,32 @@ def test_aircraft_fourx():
     user.fourx = True
     a1 = Aircraft.search("b744", user=user).ac
     assert a1.speed / a0.speed == pytest.approx(4.0)
+
+
+def test_aircraft_id_table():
+    # every id resolves to an aircraft with that id, and every priority to that engine variant (or the first one)
+    for acid in range(0, 400):
+        for priority in range(4):
+            ac = Aircraft.search(f"id:{acid}[{priority}]").ac
+            if not ac.valid:
+                continue
+            assert ac.id == acid
+            assert ac.priority in (priority, 0)
+    assert Aircraft.search("id:1[1]").ac.priority == 1
+    assert not Aircraft.search("id:54").ac.valid
+
+
+def test_aircraft_search_many():
+    results = Aircraft.suggest_many(["b744", "name:B747-400", "b7440", "a388[sfc]"])
+    assert results[0].ac.shortname == "b744" and not results[0].suggestions
+    assert results[1].ac.shortname == "b744"
+    assert results[2].ac is None
+    assert results[2].suggestions[0].ac.shortname == "b744"
+    assert results[3].ac.speed_mod and results[3].ac.fuel_mod and results[3].ac.co2_mod
+
+
+def test_aircraft_autocomplete():
+    acs = Aircraft.autocomplete("B74", n=10)
+    assert "b744" in [ac.shortname for ac in acs]
+    assert all(ac.priority == 0 for ac in acs)
+    assert [ac.capacity for ac in acs] == sorted((ac.capacity for ac in acs), reverse=True)
@@ -41,3 +41,78 @@ def test_airport_fail_and_suggest(inp):
 def test_airport_stoi_overflow(inp):
     a0 = Airport.search(inp)
     assert not a0.ap.valid
+
+
+def test_airport_id_table():
+    found = 0
+    for apid in range(1, 3983):
+        ap = Airport.search(f"id:{apid}").ap
+        if ap.valid:
+            assert ap.id == apid
+            found += 1
+    assert found == 3907  # AIRPORT_COUNT
+    assert not Airport.search("id:3983").ap.valid
+
+
+def test_airport_duplicate_keys_match_linear_scan():
+    # the airports are stored in id order: a linear scan finds the lowest id first
+    airports = [ap for apid in range(1, 3983) if (ap := Airport.search(f"id:{apid}").ap).valid]
+    first = {"iata": {}, "icao": {}, "name": {}, "fullname": {}}
+    for ap in airports:
+        name = ap.name.upper()
+        keys = {"iata": ap.iata, "icao": ap.icao, "name": name, "fullname": f"{name}, {ap.country}".upper()}
+        for kind, key in keys.items():
+            first[kind].setdefault(key, ap.id)
+    assert any(len(keys) < len(airports) for keys in first.values())  # there are duplicates to resolve
+
+    for kind, keys in first.items():
+        for key, apid in keys.items():
+            assert Airport.search(f"{kind}:{key}").ap.id == apid
+    for key in set().union(*first.values()):
+        if key.isdigit():  # resolved as an id
+            continue
+        expected = min(keys[key] for keys in first.values() if key in keys)
+        assert Airport.search(f"all:{key}").ap.id == expected
+
+
+@pytest.mark.parametrize("inp", ["name:HONG KONF", "all:SINGAPOR", "iata:HKX", "icao:VHHX"])
+def test_airport_suggest_matches_linear_scan(inp):
+    from am4.utils.db.utils import jaro_winkler_distance
+
+    airports = [ap for apid in range(1, 3983) if (ap := Airport.search(f"id:{apid}").ap).valid]
+    kind, s = inp.split(":")
+
+    def score(ap):
+        name = ap.name.upper()
+        fields = {
+            "name": [name],
+            "iata": [ap.iata],
+            "icao": [ap.icao],
+            "all": [ap.iata, ap.icao, name, f"{name}, {ap.country}".upper()],
+        }[kind]
+        return max(jaro_winkler_distance(s, f) for f in fields)
+
+    expected = sorted((score(ap) for ap in airports), reverse=True)[:5]
+    suggs = Airport.suggest(Airport.search(inp).parse_result)
+    assert [sg.score for sg in suggs] == pytest.approx(expected)
+
+
+def test_airport_search_many():
+    queries = ["iata:hkg", "VHHH", "hong kong", "iata:hkx", "id:65590"]
+    results = Airport.suggest_many(queries)
+    assert [r.ap.iata if r.ap else None for r in results] == ["HKG", "HKG", "HKG", None, None]
+    assert all(not r.suggestions for r in results[:3])
+    assert results[3].suggestions[0].ap.iata == Airport.suggest(Airport.search("iata:hkx").parse_result)[0].ap.iata
+    assert not results[4].suggestions  # ids are never suggested
+    assert all(not r.suggestions for r in Airport.search_many(queries))
+
+
+def test_airport_autocomplete():
+    aps = Airport.autocomplete("hong k", n=3)
+    assert aps[0].iata == "HKG"
+    aps = Airport.autocomplete("l", n=10)
+    assert len(aps) == 10
+    assert [ap.market for ap in aps] == sorted((ap.market for ap in aps), reverse=True)
+    for ap in aps:
+        keys = [ap.iata, ap.icao, *ap.name.upper().split(" ")]
+        assert any(k.startswith("L") for k in keys)
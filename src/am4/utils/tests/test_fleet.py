@@ -0,0 +1,56 @@
+import pytest
+
+from am4.utils.aircraft import Aircraft
+from am4.utils.airport import Airport
+from am4.utils.fleet import FleetPlanner
+from am4.utils.route import AircraftRoute, RoutesSearch
+
+
+@pytest.fixture
+def planner():
+    ap0 = Airport.search("VHHH").ap
+    return FleetPlanner(ap0, [Aircraft.search("a388").ac, Aircraft.search("b744").ac])
+
+
+def test_fleet_planner(planner):
+    plan = planner.get(max_aircraft=20)
+    assert 0 < len(plan.assignments) <= 20
+    assert plan.daily_profit == pytest.approx(sum(a.daily_profit for a in plan.assignments))
+    assert plan.cost == pytest.approx(sum(planner.aircraft[a.aircraft_idx].cost for a in plan.assignments))
+    for a in plan.assignments:
+        assert a.destination.id != planner.origin.id
+        assert a.daily_profit == pytest.approx(a.ac_route.profit * a.ac_route.trips_per_day_per_ac)
+
+    # the first aircraft on a route sees the full demand
+    best = max(
+        d.ac_route.profit * d.ac_route.trips_per_day_per_ac
+        for ac in planner.aircraft
+        for d in RoutesSearch(planner.origin, ac, AircraftRoute.Options(sort_by=AircraftRoute.Options.SortBy.PER_AC_PER_DAY)).get(1)
+    )
+    assert max(a.daily_profit for a in plan.assignments) == pytest.approx(best)
+
+
+def test_fleet_planner_consumes_demand(planner):
+    plan = planner.get(max_aircraft=50)
+    by_route = {}
+    for a in plan.assignments:
+        by_route.setdefault(a.destination.id, []).append(a.ac_route)
+    shared = [ars for ars in by_route.values() if len(ars) > 1]
+    assert shared
+    for ars in shared:
+        demand = [ar.route.pax_demand.y for ar in ars]
+        assert demand == sorted(demand, reverse=True) and demand[0] > demand[-1]
+
+
+def test_fleet_planner_budget(planner):
+    budget = 2.5 * max(ac.cost for ac in planner.aircraft)
+    plan = planner.get(max_aircraft=0, budget=budget)
+    assert 0 < len(plan.assignments) <= 3
+    assert plan.cost <= budget
+
+
+def test_fleet_planner_local_search(planner):
+    greedy = planner.get(max_aircraft=30, max_exchanges=0)
+    refined = planner.get(max_aircraft=30)
+    assert len(refined.assignments) <= 30
+    assert refined.daily_profit >= greedy.daily_profit
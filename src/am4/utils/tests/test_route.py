@@ -1,10 +1,23 @@
+import math
+import os
+import sys
+
 import pytest
 
 from am4.utils.aircraft import Aircraft
 from am4.utils.airport import Airport
+from am4.utils.db import get_num_threads, init, set_num_threads
 from am4.utils.demand import CargoDemand
 from am4.utils.game import User
-from am4.utils.route import AircraftRoute, Route, RoutesSearch, SameOdException
+from am4.utils.route import (
+    AircraftRoute,
+    GlobalRoutesSearch,
+    HubSearch,
+    ReverseRoutesSearch,
+    Route,
+    RoutesSearch,
+    SameOdException,
+)
 
 
 def test_route():
@@ -104,6 +117,54 @@ def test_route_with_aircraft_auto():
     assert r.trips_per_day_per_ac == 13
 
 
+@pytest.mark.parametrize("iata", ["TPE", "LHR", "JFK"])
+def test_route_with_aircraft_best(iata):
+    ap0 = Airport.search("VHHH").ap
+    ap1 = Airport.search(iata).ap
+    ac = Aircraft.search("b744").ac
+    user = User.Default()
+
+    def create(algorithm):
+        options = AircraftRoute.Options(
+            tpd_mode=AircraftRoute.Options.TPDMode.STRICT, trips_per_day_per_ac=1, config_algorithm=algorithm
+        )
+        return AircraftRoute.create(ap0, ap1, ac, options, user)
+
+    orders = [a for name, a in Aircraft.PaxConfig.Algorithm.__members__.items() if name not in ("AUTO", "BEST")]
+    incomes = {a: r.max_income for a in orders if (r := create(a)).valid}
+    r = create(Aircraft.PaxConfig.Algorithm.BEST)
+    assert r.valid
+    assert r.max_income == max(incomes.values())
+    assert r.config.algorithm in orders
+    assert r.max_income == incomes[r.config.algorithm]
+
+
+@pytest.mark.parametrize("iata", ["TPE", "LHR", "JFK"])
+@pytest.mark.parametrize("tpd_mode", [AircraftRoute.Options.TPDMode.AUTO, AircraftRoute.Options.TPDMode.STRICT])
+def test_route_with_aircraft_ci_mode(iata, tpd_mode):
+    ap0 = Airport.search("VHHH").ap
+    ap1 = Airport.search(iata).ap
+    ac = Aircraft.search("b744").ac
+
+    def create(ci_mode):
+        options = AircraftRoute.Options(tpd_mode=tpd_mode, ci_mode=ci_mode)
+        return AircraftRoute.create(ap0, ap1, ac, options)
+
+    r_max = create(AircraftRoute.Options.CIMode.MAX)
+    assert r_max.ci == 200
+    for ci_mode, daily in (
+        (AircraftRoute.Options.CIMode.PROFIT, lambda r: r.profit * r.trips_per_day_per_ac),
+        (AircraftRoute.Options.CIMode.CONTRIBUTION, lambda r: r.contribution * r.trips_per_day_per_ac),
+    ):
+        r = create(ci_mode)
+        assert r.valid
+        assert 0 <= r.ci <= 200
+        assert daily(r) >= daily(r_max)
+        assert r.flight_time == pytest.approx(r_max.flight_time / (0.3 + 0.0035 * r.ci))
+        assert r.fuel == pytest.approx(r_max.fuel * (r.ci / 500 + 0.6))
+        assert r.contribution >= r_max.contribution
+
+
 def test_route_with_aircraft_strict_allow_multiple_ac():
     ap0 = Airport.search("VHHH").ap
     ap1 = Airport.search("TPE").ap
@@ -229,6 +290,65 @@ def test_route_stopover():
     assert r.stopover.full_distance - r.route.direct_distance == pytest.approx(7.550770485)
 
 
+def test_route_stopover_cache():
+    ap0 = Airport.search("VHHH").ap
+    ap1 = Airport.search("LHR").ap
+    ac = Aircraft.search("mc214").ac
+    AircraftRoute.Stopover.cache_clear()
+
+    s0 = AircraftRoute.Stopover.find_by_efficiency(ap0, ap1, ac, User.GameMode.EASY)
+    assert AircraftRoute.Stopover.cache_stats()["misses"] == 1
+    r = AircraftRoute.create(ap0, ap1, ac)
+    stats = AircraftRoute.Stopover.cache_stats()
+    assert stats["hits"] == 1
+    assert stats["size"] == 1
+    assert r.stopover.airport.iata == s0.airport.iata == "PLX"
+    assert r.stopover.full_distance == s0.full_distance
+
+
+@pytest.mark.parametrize("game_mode", [User.GameMode.EASY, User.GameMode.REALISM])
+@pytest.mark.parametrize("ac_name", ["mc214", "a388"])
+def test_route_stopover_matches_linear_scan(game_mode, ac_name):
+    ac = Aircraft.search(ac_name).ac
+    airports = [ap for apid in range(1, 3983) if (ap := Airport.search(f"id:{apid}").ap).valid]
+
+    def farthest_across(ap0, key):  # across the pole: the other side of the globe, as close to the pole as possible
+        return key([ap for ap in airports if abs((ap.lng - ap0.lng + 180) % 360 - 180) > 150], key=lambda ap: ap.lat)
+
+    north, south = max(airports, key=lambda ap: ap.lat), min(airports, key=lambda ap: ap.lat)
+    southern = [ap for ap in airports if ap.lat < -10]
+    pairs = [
+        (Airport.search("VHHH").ap, Airport.search("LHR").ap),
+        (Airport.search("VHHH").ap, Airport.search("TNR").ap),
+        (north, farthest_across(north, max)),
+        (south, farthest_across(south, min)),
+        (north, south),
+        # across the antimeridian
+        (max(airports, key=lambda ap: ap.lng), min(airports, key=lambda ap: ap.lng)),
+        (max(southern, key=lambda ap: ap.lng), min(southern, key=lambda ap: ap.lng)),
+    ]
+    rwy_requirement = 0 if game_mode == User.GameMode.EASY else ac.rwy
+    for ap0, ap1 in pairs:
+        # the lowest total distance within range of both ends, ties to the lowest id: the airports are in id order
+        expected = None
+        for ap in airports:
+            if ap.rwy < rwy_requirement or ap.id in (ap0.id, ap1.id):
+                continue
+            d0 = Route.create(ap0, ap).direct_distance
+            d1 = Route.create(ap1, ap).direct_distance
+            if not (100 <= d0 <= ac.range and 100 <= d1 <= ac.range):
+                continue
+            if expected is None or (d0 + d1, ap.id) < expected:
+                expected = (d0 + d1, ap.id)
+
+        s = AircraftRoute.Stopover.find_by_efficiency(ap0, ap1, ac, game_mode)
+        if expected is None:
+            assert not s.exists, (ap0.iata, ap1.iata)
+        else:
+            assert s.exists, (ap0.iata, ap1.iata)
+            assert (s.full_distance, s.airport.id) == (pytest.approx(expected[0]), expected[1]), (ap0.iata, ap1.iata)
+
+
 def test_route_realism_rwy_too_short():
     ap0 = Airport.search("VHHH").ap
     ap1 = Airport.search("RCLY").ap
@@ -311,6 +431,253 @@ def test_find_routes():
     assert dests[0].ac_route.route.direct_distance == pytest.approx(10891.46)
 
 
+def test_find_routes_top_k():
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("mc214").ac
+    for sort_by in (AircraftRoute.Options.SortBy.PER_TRIP, AircraftRoute.Options.SortBy.PER_AC_PER_DAY):
+        rs = RoutesSearch(ap0, ac, AircraftRoute.Options(sort_by=sort_by))
+        dests = rs.get()
+        top = rs.get(top_k=10)
+        assert len(top) == 10
+        assert [d.airport.id for d in top] == [d.airport.id for d in dests[:10]]
+        assert [d.ac_route.profit for d in top] == [d.ac_route.profit for d in dests[:10]]
+    assert len(rs.get(top_k=100000)) == len(dests)
+
+
+def _stack_fjy_one_by_one(ar, capacity: int, user: User):
+    """tpd_sweep's stacking of aircraft on an FJY route, adding one aircraft at a time"""
+    pd = ar.route.pax_demand
+    load_adj = [math.floor(x / user.load) for x in (pd.y, pd.j, pd.f)]
+
+    def calc_cfg(tpd: float):
+        y, j, f = (math.floor(x / tpd) for x in load_adj)
+        cfg_f = min(f, capacity // 3)
+        cfg_j = min(j, (capacity - cfg_f * 3) // 2)
+        cfg_y = capacity - cfg_f * 3 - cfg_j * 2
+        return (cfg_y, cfg_j, cfg_f), cfg_y < y
+
+    def calc_income(cfg) -> int:
+        return cfg[0] * ar.ticket.y + cfg[1] * ar.ticket.j + cfg[2] * ar.ticket.f
+
+    tpdpa = float(ar.trips_per_day_per_ac)
+    cfg, _valid = calc_cfg(tpdpa)
+    max_income = calc_income(cfg)
+    max_income_bnd = max_income * (1 - user.income_loss_tol)
+    num_ac = 1
+    for i in range(2, 200):
+        i_cfg, valid = calc_cfg(tpdpa * i)
+        if not valid or calc_income(i_cfg) < max_income_bnd:
+            break
+        cfg, max_income, num_ac = i_cfg, calc_income(i_cfg), i
+    return num_ac, cfg, max_income
+
+
+def test_find_routes_stacking_matches_one_by_one():
+    user = User.Default()
+    checked = 0
+    for ac_name in ("c172", "b744"):
+        ac = Aircraft.search(ac_name).ac
+        dests = RoutesSearch(Airport.search("VHHH").ap, ac).get()
+        for d in dests:
+            ar = d.ac_route
+            if ar.config.algorithm != Aircraft.PaxConfig.Algorithm.FJY:
+                continue
+            num_ac, cfg, max_income = _stack_fjy_one_by_one(ar, ac.capacity, user)
+            assert (ar.num_ac, (ar.config.y, ar.config.j, ar.config.f), ar.max_income) == (num_ac, cfg, max_income)
+            checked += 1
+    assert checked > 100
+
+
+def test_find_routes_parallel():
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("a388").ac
+    options = AircraftRoute.Options(sort_by=AircraftRoute.Options.SortBy.PER_AC_PER_DAY)
+    serial = RoutesSearch(ap0, ac, options).get()
+
+    set_num_threads(4)
+    try:
+        assert get_num_threads() == 4
+        parallel = RoutesSearch(ap0, ac, options).get()
+    finally:
+        set_num_threads(1)
+    assert [d.airport.id for d in parallel] == [d.airport.id for d in serial]
+    assert [d.ac_route.profit for d in parallel] == [d.ac_route.profit for d in serial]
+
+
+def test_routes_search_pareto_front():
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("a388").ac
+    objectives = [RoutesSearch.Objective.PROFIT_PER_DAY, RoutesSearch.Objective.CONTRIBUTION_PER_DAY]
+
+    def point(d):
+        ar = d.ac_route
+        return (ar.profit * ar.trips_per_day_per_ac, ar.contribution * ar.trips_per_day_per_ac)
+
+    def dominates(p, q):
+        return all(a >= b for a, b in zip(p, q)) and p != q
+
+    points = {d.airport.id: point(d) for d in RoutesSearch(ap0, ac).get()}
+    expected = {i for i, p in points.items() if not any(dominates(q, p) for q in points.values())}
+    front = RoutesSearch(ap0, ac).get_pareto_front(objectives)
+    assert {d.airport.id for d in front} == expected
+    profits = [point(d)[0] for d in front]
+    assert profits == sorted(profits, reverse=True)
+
+    set_num_threads(4)
+    try:
+        parallel = RoutesSearch(ap0, ac).get_pareto_front()
+    finally:
+        set_num_threads(1)
+    assert [d.airport.id for d in parallel] == [d.airport.id for d in front]
+
+    with pytest.raises(ValueError):
+        RoutesSearch(ap0, ac).get_pareto_front([])
+
+
+@pytest.mark.parametrize(
+    "sort_by,score",
+    [
+        ("PER_FLIGHT_HOUR", lambda ar, ac, ap0: ar.profit / ar.flight_time),
+        ("PER_AC_COST", lambda ar, ac, ap0: ar.profit * ar.trips_per_day_per_ac / ac.cost),
+        ("CONTRIBUTION_PER_AC_PER_DAY", lambda ar, ac, ap0: ar.contribution * ar.trips_per_day_per_ac),
+        ("NET_OF_HUB_COST", lambda ar, ac, ap0: ar.profit * ar.trips_per_day_per_ac - ap0.hub_cost / 30),
+        ("WEIGHTED", lambda ar, ac, ap0: (ar.profit + 500 * ar.contribution) * ar.trips_per_day_per_ac),
+    ],
+)
+def test_routes_search_sort_by(sort_by, score):
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("a388").ac
+    SortBy = AircraftRoute.Options.SortBy
+    options = AircraftRoute.Options(
+        sort_by=SortBy.__members__[sort_by],
+        sort_weights=[(SortBy.PER_AC_PER_DAY, 1.0), (SortBy.CONTRIBUTION_PER_AC_PER_DAY, 500.0)],
+        amortisation_days=30,
+    )
+    dests = RoutesSearch(ap0, ac, options).get()
+    scores = [score(d.ac_route, ac, ap0) for d in dests]
+    assert scores == pytest.approx(sorted(scores, reverse=True))
+    # ranked inside the scan, so the top k are the first k of the full list
+    assert [d.airport.id for d in RoutesSearch(ap0, ac, options).get(top_k=10)] == [d.airport.id for d in dests[:10]]
+
+
+def test_global_routes_search():
+    ac = Aircraft.search("c172").ac
+    options = AircraftRoute.Options(max_distance=1000)
+    expected = []
+    for r in Airport.search_many([f"id:{i}" for i in range(1, 3983)]):
+        if r.ap is not None:
+            expected += [(-d.ac_route.profit, r.ap.id, d.airport.id) for d in RoutesSearch(r.ap, ac, options).get(50)]
+    expected.sort()
+
+    set_num_threads(4)
+    try:
+        result = GlobalRoutesSearch(ac, options).get(top_k=50)
+    finally:
+        set_num_threads(1)
+    assert len(result) == 50
+    assert list(zip(result.origin_id, result.destination_id)) == [(o, d) for _, o, d in expected[:50]]
+    assert result.profit.tolist() == [-p for p, _, _ in expected[:50]]
+    assert len(result.config_y) == 50 and len(result.config_l) == 0
+
+    unique = GlobalRoutesSearch(ac, options).get(top_k=50, both_directions=False)
+    pairs = [frozenset((o, d)) for o, d in zip(unique.origin_id, unique.destination_id)]
+    assert len(set(pairs)) == 50
+
+
+def test_reverse_routes_search():
+    ap1 = Airport.search("VHHH").ap
+    ac = Aircraft.search("b744").ac
+    origins = ReverseRoutesSearch(ap1, ac).get()
+    assert len(origins) > 100
+    assert all(o.airport.id != ap1.id for o in origins)
+    profits = [o.ac_route.profit for o in origins]
+    assert profits == sorted(profits, reverse=True)
+    # every route into VHHH is the route out of it, the other way round
+    for o in origins[:5]:
+        ar = AircraftRoute.create(o.airport, ap1, ac)
+        assert ar.profit == o.ac_route.profit
+    assert [o.airport.id for o in ReverseRoutesSearch(ap1, ac).get(top_k=5)] == [o.airport.id for o in origins[:5]]
+
+
+def test_hub_search():
+    ac = Aircraft.search("c172").ac
+    options = AircraftRoute.Options(max_distance=1000)
+    HubSearch.clear_cache()
+    hubs = HubSearch(ac, options).get(top_n=5, amortisation_days=30, top_k=10)
+    assert len(hubs) == 10
+    scores = [h.score for h in hubs]
+    assert scores == sorted(scores, reverse=True)
+
+    best = hubs[0]
+    dests = RoutesSearch(best.airport, ac, options).get()
+    daily = sorted((d.ac_route.profit * d.ac_route.trips_per_day_per_ac for d in dests), reverse=True)[:5]
+    assert best.num_routes == len(daily)
+    assert best.routes_profit == pytest.approx(sum(daily))
+    assert best.score == pytest.approx(sum(daily) - best.airport.hub_cost / 30)
+
+    # re-ranked from the cache
+    no_amortisation = HubSearch(ac, options).get(top_n=5, amortisation_days=0, top_k=10)
+    assert all(h.score == h.routes_profit for h in no_amortisation)
+
+
+def test_compact_distances():
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("a388").ac
+    dense = {d.airport.id: d.ac_route for d in RoutesSearch(ap0, ac).get()}
+
+    init(compact_distances=True)
+    try:
+        r = Route.create(ap0, Airport.search("LHR").ap)
+        assert r.direct_distance == pytest.approx(9630, abs=1)
+        compact = {d.airport.id: d.ac_route for d in RoutesSearch(ap0, ac).get()}
+    finally:
+        init()
+    common = dense.keys() & compact.keys()
+    assert len(common) >= len(dense) * 0.999
+    for apid in common:
+        assert compact[apid].route.direct_distance == pytest.approx(dense[apid].route.direct_distance, abs=2e-3)
+        assert compact[apid].profit == pytest.approx(dense[apid].profit, rel=1e-3, abs=1)
+
+
+def test_snapshot():
+    # conftest's init() either wrote the snapshot or started from it
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("a388").ac
+    from_snapshot = [(d.airport.id, d.ac_route.profit) for d in RoutesSearch(ap0, ac).get()]
+    init(use_snapshot=False)
+    try:
+        assert Airport.search("VHHH").ap.fullname == ap0.fullname
+        from_parquet = [(d.airport.id, d.ac_route.profit) for d in RoutesSearch(ap0, ac).get()]
+    finally:
+        init()
+    assert from_snapshot == from_parquet
+
+
+@pytest.mark.skipif(not sys.platform.startswith("linux"), reason="segments are only visible under /dev/shm on linux")
+def test_shared_memory():
+    ap0 = Airport.search("VHHH").ap
+    ac = Aircraft.search("a388").ac
+    expected = [(d.airport.id, d.ac_route.profit) for d in RoutesSearch(ap0, ac).get()]
+    segments = ["/dev/shm/am4utils-test", "/dev/shm/am4utils-test-compact"]
+    try:
+        init(shared_memory="am4utils-test")  # publishes
+        size = os.path.getsize(segments[0])
+        init(shared_memory="am4utils-test")  # attaches, leaving the segment alone
+        assert os.path.getsize(segments[0]) == size
+        assert [(d.airport.id, d.ac_route.profit) for d in RoutesSearch(ap0, ac).get()] == expected
+
+        # only the distance table of its own mode: the dense one is 3907 * 3907 * 8 B, the compact one 7630371 * 4 B
+        init(shared_memory="am4utils-test", compact_distances=True)
+        compact_size = os.path.getsize(segments[1])
+        assert abs((size - compact_size) - (122_117_192 - 30_521_484)) < 128  # sections are 64 B aligned
+        assert os.path.getsize(segments[0]) == size
+    finally:
+        init()
+        for segment in segments:
+            if os.path.exists(segment):
+                os.remove(segment)
+
+
 def test_export_routes_vip():
     ap0 = Airport.search("CAN").ap
     ac = Aircraft.search("a32vip[sfc]").ac
@@ -320,9 +687,24 @@ def test_export_routes_vip():
     rs = RoutesSearch(ap0, ac, options)
     dests = rs.get()
     assert len(dests) > 10
-    cols = rs._get_columns(dests)
-    assert len(list(cols.values())[0]) == len(dests)
-    assert len(cols) == 34
+    cols = rs.get_columns(dests)
+    assert len(cols) == len(dests)
+    assert cols.destination_id.tolist() == [d.airport.id for d in dests]
+    assert cols.profit.tolist() == [d.ac_route.profit for d in dests]
+    assert cols.destination_iata.tolist() == [d.airport.iata for d in dests]
+    stopovers = [d.ac_route.stopover.airport.icao if d.ac_route.needs_stopover else "" for d in dests]
+    assert cols.stopover_icao.tolist() == stopovers
+    assert cols.destination_name.offsets[-1] == len(cols.destination_name.data)
+    assert len(cols.ticket_y) == len(dests) and len(cols.ticket_l) == 0
+
+    # written by the search itself, and viewed without a copy
+    direct = rs.get_columns()
+    assert direct.destination_id.tolist() == cols.destination_id.tolist()
+    profit = direct.profit
+    assert profit.format == "d" and profit.readonly
+    del direct
+    assert profit.tolist() == cols.profit.tolist()
+    assert [d.airport.id for d in rs.get(top_k=5)] == rs.get_columns(top_k=5).destination_id.tolist()
 
 
 def test_load():